@@ -1,5 +1,6 @@
 #include "../../src/treap.hpp"
 #include <iostream>
+#include <string>
 
 using algo::treap;
 
@@ -9,18 +10,16 @@ int main() {
 
   int n, m;
   std::cin >> n >> m;
+  std::string s;
+  std::cin >> s;
   treap<char> str;
-  for (int i = 0; i < n; ++i) {
-    char c;
-    std::cin >> c;
-    str.insert(i, c);
-  }
+  str.append(s);
 
   while (m--) {
     int a, b;
     std::cin >> a >> b;
     --a, --b;
-    str.merge(str.cut(a - 1, b - 1));
+    str.merge(str.cut(a, b));
   }
 
   for (int i = 0; i < n; ++i) {
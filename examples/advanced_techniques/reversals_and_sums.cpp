@@ -1,5 +1,6 @@
 #include "../../src/lazy_treap.hpp"
 #include <iostream>
+#include <vector>
 
 using algo::lazy_treap;
 
@@ -9,11 +10,11 @@ int main() {
 
   int n, m;
   std::cin >> n >> m;
-  lazy_treap<int64_t> treap;
-  for (int i = 0, x; i < n; ++i) {
+  std::vector<int64_t> a(n);
+  for (auto &x : a) {
     std::cin >> x;
-    treap.insert(i, x);
   }
+  lazy_treap<int64_t> treap(a);
 
   while (m--) {
     int t, a, b;
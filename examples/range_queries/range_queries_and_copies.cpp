@@ -0,0 +1,35 @@
+#include "../../src/persistent_segment_tree.hpp"
+#include <iostream>
+
+using algo::persistent_segment_tree;
+
+int main() {
+  std::ios::sync_with_stdio(false);
+  std::cin.tie(nullptr);
+
+  int n, q;
+  std::cin >> n >> q;
+  std::vector<int64_t> a(n);
+  for (int64_t &i : a) {
+    std::cin >> i;
+  }
+  persistent_segment_tree<int64_t> st(a);
+  st.reserve(q * (std::bit_width(unsigned(n)) + 1));
+  std::vector<std::size_t> arrays = {0};
+  while (q--) {
+    int type, k;
+    std::cin >> type >> k;
+    --k;
+    if (type == 1) {
+      int i, x;
+      std::cin >> i >> x;
+      arrays[k] = st.set(arrays[k], i - 1, x);
+    } else if (type == 2) {
+      int l, r;
+      std::cin >> l >> r;
+      std::cout << st.query(arrays[k], l - 1, r - 1) << '\n';
+    } else {
+      arrays.push_back(arrays[k]);
+    }
+  }
+}
@@ -1,6 +1,7 @@
 #include "../../src/internal_lazy_treap.hpp"
 #include "../../src/mint.hpp"
 #include <iostream>
+#include <vector>
 
 using algo::internal::lazy_treap;
 using mint = algo::mint<998244353>;
@@ -15,9 +16,10 @@ struct linear {
 };
 
 struct traits {
-  static void apply(mint &a, const linear &f, int len) {
-    a = f.a * a + f.b * len;
+  static void apply(mint &a, const linear &f, int64_t len) {
+    a = f.a * a + f.b * mint(len);
   }
+  static void reverse(mint &) {}
 };
 
 int main() {
@@ -26,11 +28,12 @@ int main() {
 
   int n, q;
   std::cin >> n >> q;
-  lazy_treap<mint, linear, traits> treap;
+  std::vector<mint> a(n);
   for (int i = 0, x; i < n; ++i) {
     std::cin >> x;
-    treap.insert(i, x);
+    a[i] = x;
   }
+  lazy_treap<mint, std::plus<>, algo::monoid_identity<mint, std::plus<>>, linear, traits> treap(a);
 
   while (q--) {
     int type;
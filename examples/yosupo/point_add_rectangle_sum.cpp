@@ -0,0 +1,40 @@
+#include "../../src/offline_fenwick_tree.hpp"
+#include <array>
+#include <iostream>
+#include <vector>
+
+using algo::offline_fenwick_tree;
+
+int main() {
+  std::ios::sync_with_stdio(false);
+  std::cin.tie(nullptr);
+
+  int n, q;
+  std::cin >> n >> q;
+  std::vector<std::pair<int64_t, int64_t>> points(n);
+  std::vector<int64_t> w(n);
+  for (int i = 0; i < n; ++i) {
+    std::cin >> points[i].first >> points[i].second >> w[i];
+  }
+  std::vector<std::array<int64_t, 5>> queries(q);
+  for (auto &[type, a, b, c, d] : queries) {
+    std::cin >> type >> a >> b >> c;
+    if (type == 0) {
+      points.push_back({a, b});
+    } else {
+      std::cin >> d;
+    }
+  }
+
+  offline_fenwick_tree<int64_t> fen(points);
+  for (int i = 0; i < n; ++i) {
+    fen.apply(points[i].first, points[i].second, w[i]);
+  }
+  for (auto [type, a, b, c, d] : queries) {
+    if (type == 0) {
+      fen.apply(a, b, c);
+    } else {
+      std::cout << fen.query(a, c - 1, b, d - 1) << '\n';
+    }
+  }
+}
@@ -0,0 +1,36 @@
+#include "../../src/beats_segment_tree.hpp"
+#include <iostream>
+#include <vector>
+
+using algo::beats_segment_tree;
+
+int main() {
+  std::ios::sync_with_stdio(false);
+  std::cin.tie(nullptr);
+
+  int n, q;
+  std::cin >> n >> q;
+  std::vector<int64_t> a(n);
+  for (auto &x : a) {
+    std::cin >> x;
+  }
+  beats_segment_tree<int64_t> st(a);
+
+  while (q--) {
+    int type, l, r;
+    std::cin >> type >> l >> r;
+    if (type == 3) {
+      std::cout << st.query_sum(l, r - 1) << '\n';
+      continue;
+    }
+    int64_t b;
+    std::cin >> b;
+    if (type == 0) {
+      st.chmin(l, r - 1, b);
+    } else if (type == 1) {
+      st.chmax(l, r - 1, b);
+    } else {
+      st.add(l, r - 1, b);
+    }
+  }
+}
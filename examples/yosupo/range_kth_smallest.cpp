@@ -0,0 +1,24 @@
+#include "../../src/wavelet_matrix.hpp"
+#include <iostream>
+#include <vector>
+
+using algo::wavelet_matrix;
+
+int main() {
+  std::ios::sync_with_stdio(false);
+  std::cin.tie(nullptr);
+
+  int n, q;
+  std::cin >> n >> q;
+  std::vector<int> a(n);
+  for (auto &x : a) {
+    std::cin >> x;
+  }
+  wavelet_matrix<int> wm(a);
+
+  while (q--) {
+    int l, r, k;
+    std::cin >> l >> r >> k;
+    std::cout << wm.kth_smallest(l, r - 1, k) << '\n';
+  }
+}
@@ -0,0 +1,28 @@
+#include "../../src/mint.hpp"
+#include "../../src/potential_dsu.hpp"
+#include <iostream>
+
+using algo::potential_dsu;
+using mint = algo::mint<998244353>;
+
+int main() {
+  std::ios::sync_with_stdio(false);
+  std::cin.tie(nullptr);
+
+  int n, q;
+  std::cin >> n >> q;
+  potential_dsu<int, mint> d(n);
+  while (q--) {
+    int type, u, v;
+    std::cin >> type >> u >> v;
+    if (type == 0) {
+      int64_t x;
+      std::cin >> x;
+      std::cout << d.merge(v, u, x) << '\n';
+    } else if (auto w = d.diff(v, u)) {
+      std::cout << *w << '\n';
+    } else {
+      std::cout << -1 << '\n';
+    }
+  }
+}
@@ -1,13 +1,22 @@
 #pragma once
 
+#include "executor.hpp"
 #include "min_t.hpp"
 #include "max_t.hpp"
 #include "xor_t.hpp"
 #include "segment_tree.hpp"
+#include "segment_tree_layout.hpp"
 #include "sparse_segment_tree.hpp"
+#include "pooled_sparse_segment_tree.hpp"
+#include "persistent_segment_tree.hpp"
+#include "beats_segment_tree.hpp"
 #include "fenwick_tree.hpp"
+#include "range_fenwick_tree.hpp"
+#include "offline_fenwick_tree.hpp"
 #include "nd_fenwick_tree.hpp"
 #include "lazy_segment_tree.hpp"
+#include "lazy_sparse_segment_tree.hpp"
+#include "wavelet_matrix.hpp"
 
 #include "dense_map.hpp"
 #include "serialized_array.hpp"
@@ -23,10 +32,17 @@
 
 #include "dsu.hpp"
 #include "dsu_with_rollbacks.hpp"
+#include "potential_dsu.hpp"
+#include "concurrent_dsu.hpp"
+#include "offline_dynamic_connectivity.hpp"
+#include "node_pool.hpp"
 #include "treap.hpp"
 
 #include "convolute.hpp"
 
 #include "matrix.hpp"
 
-#include "sparse_lichao_tree.hpp"
\ No newline at end of file
+#include "sparse_lichao_tree.hpp"
+#include "lichao_tree.hpp"
+#include "monotone_cht.hpp"
+#include "kinetic_segment_tree.hpp"
\ No newline at end of file
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <vector>
+
+namespace algo {
+/// @brief A segment tree beats (Ji's segment tree) supporting range `chmin`, `chmax` and `add`,
+/// with range sum, max and min queries. Updates take amortised `O(log^2 n)`.
+/// @tparam T An arithmetic type, wide enough to hold range sums.
+template <typename T>
+class beats_segment_tree {
+private:
+  static constexpr T inf = std::numeric_limits<T>::max(), ninf = std::numeric_limits<T>::lowest();
+
+  // Every node keeps its two largest and two smallest distinct values, with the multiplicity of
+  // the extremes. A chmin that lies strictly between `max2` and `max1` only changes the `max_cnt`
+  // elements equal to `max1`, so it can be applied to the whole node at once; `add` is the only
+  // explicit tag, chmin/chmax tags are implied by a parent's `max1`/`min1`. Padding leaves have
+  // `len == 0` and are never updated.
+  struct node {
+    T sum = 0, max1 = ninf, max2 = ninf, min1 = inf, min2 = inf, add = 0;
+    int max_cnt = 0, min_cnt = 0, len = 0;
+  };
+
+  std::size_t _n, n;
+  std::vector<node> seg;
+
+  void set_leaf(node &d, const T &x) {
+    d.sum = d.max1 = d.min1 = x;
+    d.max2 = ninf, d.min2 = inf;
+    d.max_cnt = d.min_cnt = d.len = 1;
+  }
+
+  void pull(std::size_t i) {
+    node &d = seg[i];
+    const node &l = seg[2 * i], &r = seg[2 * i + 1];
+    d.sum = l.sum + r.sum;
+    d.len = l.len + r.len;
+    if (l.max1 == r.max1) {
+      d.max1 = l.max1, d.max_cnt = l.max_cnt + r.max_cnt, d.max2 = std::max(l.max2, r.max2);
+    } else if (l.max1 > r.max1) {
+      d.max1 = l.max1, d.max_cnt = l.max_cnt, d.max2 = std::max(l.max2, r.max1);
+    } else {
+      d.max1 = r.max1, d.max_cnt = r.max_cnt, d.max2 = std::max(l.max1, r.max2);
+    }
+    if (l.min1 == r.min1) {
+      d.min1 = l.min1, d.min_cnt = l.min_cnt + r.min_cnt, d.min2 = std::min(l.min2, r.min2);
+    } else if (l.min1 < r.min1) {
+      d.min1 = l.min1, d.min_cnt = l.min_cnt, d.min2 = std::min(l.min2, r.min1);
+    } else {
+      d.min1 = r.min1, d.min_cnt = r.min_cnt, d.min2 = std::min(l.min1, r.min2);
+    }
+  }
+
+  // Lowers `max1` to `x`, where `max2 < x < max1`.
+  void apply_chmin(node &d, const T &x) {
+    d.sum += (x - d.max1) * d.max_cnt;
+    if (d.max1 == d.min1) {
+      d.min1 = x;
+    } else if (d.max1 == d.min2) {
+      d.min2 = x;
+    }
+    d.max1 = x;
+  }
+
+  // Raises `min1` to `x`, where `min1 < x < min2`.
+  void apply_chmax(node &d, const T &x) {
+    d.sum += (x - d.min1) * d.min_cnt;
+    if (d.min1 == d.max1) {
+      d.max1 = x;
+    } else if (d.min1 == d.max2) {
+      d.max2 = x;
+    }
+    d.min1 = x;
+  }
+
+  void apply_add(node &d, const T &x) {
+    if (d.len == 0) {
+      return;
+    }
+    d.sum += x * d.len;
+    d.max1 += x, d.min1 += x, d.add += x;
+    if (d.max2 != ninf) {
+      d.max2 += x;
+    }
+    if (d.min2 != inf) {
+      d.min2 += x;
+    }
+  }
+
+  void push(std::size_t i) {
+    node &d = seg[i];
+    for (std::size_t c : {2 * i, 2 * i + 1}) {
+      node &e = seg[c];
+      if (d.add != 0) {
+        apply_add(e, d.add);
+      }
+      if (e.max1 > d.max1) {
+        apply_chmin(e, d.max1);
+      }
+      if (e.min1 < d.min1) {
+        apply_chmax(e, d.min1);
+      }
+    }
+    d.add = 0;
+  }
+
+  void chmin(std::size_t i, std::size_t lo, std::size_t hi, std::size_t l, std::size_t r, const T &x) {
+    if (r < lo || hi <= l || seg[i].max1 <= x) {
+      return;
+    }
+    if (l <= lo && hi - 1 <= r && seg[i].max2 < x) {
+      apply_chmin(seg[i], x);
+      return;
+    }
+    push(i);
+    std::size_t mid = (lo + hi) / 2;
+    chmin(2 * i, lo, mid, l, r, x);
+    chmin(2 * i + 1, mid, hi, l, r, x);
+    pull(i);
+  }
+
+  void chmax(std::size_t i, std::size_t lo, std::size_t hi, std::size_t l, std::size_t r, const T &x) {
+    if (r < lo || hi <= l || seg[i].min1 >= x) {
+      return;
+    }
+    if (l <= lo && hi - 1 <= r && seg[i].min2 > x) {
+      apply_chmax(seg[i], x);
+      return;
+    }
+    push(i);
+    std::size_t mid = (lo + hi) / 2;
+    chmax(2 * i, lo, mid, l, r, x);
+    chmax(2 * i + 1, mid, hi, l, r, x);
+    pull(i);
+  }
+
+  void add(std::size_t i, std::size_t lo, std::size_t hi, std::size_t l, std::size_t r, const T &x) {
+    if (r < lo || hi <= l) {
+      return;
+    }
+    if (l <= lo && hi - 1 <= r) {
+      apply_add(seg[i], x);
+      return;
+    }
+    push(i);
+    std::size_t mid = (lo + hi) / 2;
+    add(2 * i, lo, mid, l, r, x);
+    add(2 * i + 1, mid, hi, l, r, x);
+    pull(i);
+  }
+
+  // Calls `fn` on the canonical nodes of [l, r], from left to right, after pushing their ancestors.
+  template <typename Fn>
+  void visit(std::size_t i, std::size_t lo, std::size_t hi, std::size_t l, std::size_t r, Fn &&fn) {
+    if (r < lo || hi <= l) {
+      return;
+    }
+    if (l <= lo && hi - 1 <= r) {
+      fn(seg[i]);
+      return;
+    }
+    push(i);
+    std::size_t mid = (lo + hi) / 2;
+    visit(2 * i, lo, mid, l, r, fn);
+    visit(2 * i + 1, mid, hi, l, r, fn);
+  }
+
+public:
+  beats_segment_tree(std::size_t _n) : beats_segment_tree(std::vector<T>(_n)) {}
+  beats_segment_tree(const std::vector<T> &vals) : _n(vals.size()), n(std::bit_ceil(vals.size())), seg(2 * n) {
+    for (std::size_t i = 0; i < _n; ++i) {
+      set_leaf(seg[n + i], vals[i]);
+    }
+    for (std::size_t i = n - 1; i > 0; --i) {
+      pull(i);
+    }
+  }
+
+  /// @brief Replaces every value `a[i]` in [l, r] with `min(a[i], x)`.
+  void chmin(std::size_t l, std::size_t r, const T &x) { chmin(1, 0, n, l, r, x); }
+
+  /// @brief Replaces every value `a[i]` in [l, r] with `max(a[i], x)`.
+  void chmax(std::size_t l, std::size_t r, const T &x) { chmax(1, 0, n, l, r, x); }
+
+  /// @brief Adds `x` to every value in [l, r].
+  void add(std::size_t l, std::size_t r, const T &x) { add(1, 0, n, l, r, x); }
+
+  /// @brief Returns the sum of the values in [l, r].
+  T query_sum(std::size_t l, std::size_t r) {
+    T ans = 0;
+    visit(1, 0, n, l, r, [&](const node &d) { ans += d.sum; });
+    return ans;
+  }
+
+  /// @brief Returns the largest value in [l, r].
+  T query_max(std::size_t l, std::size_t r) {
+    T ans = ninf;
+    visit(1, 0, n, l, r, [&](const node &d) { ans = std::max(ans, d.max1); });
+    return ans;
+  }
+
+  /// @brief Returns the smallest value in [l, r].
+  T query_min(std::size_t l, std::size_t r) {
+    T ans = inf;
+    visit(1, 0, n, l, r, [&](const node &d) { ans = std::min(ans, d.min1); });
+    return ans;
+  }
+
+  /// @brief Returns the value at index `i`.
+  T at(std::size_t i) { return query_sum(i, i); }
+
+  std::size_t size() const { return _n; }
+};
+} // namespace algo
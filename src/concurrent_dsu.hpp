@@ -0,0 +1,121 @@
+#pragma once
+
+#include "executor.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace algo {
+/// @brief A lock-free disjoint set union that any number of threads may use at once. Roots are
+/// linked with a compare-and-swap, the root with the lower random priority going below the other,
+/// so trees stay `O(log n)` deep whatever order the merges come in; `root` shortens paths by
+/// path splitting.
+class concurrent_dsu {
+private:
+  std::uint64_t seed;
+  std::vector<std::atomic<int>> par, m_size;
+
+  std::uint64_t priority(int u) const {
+    std::uint64_t x = seed + std::uint64_t(u) * 0x9e3779b97f4a7c15;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+  }
+
+  bool below(int u, int v) const {
+    std::uint64_t pu = priority(u), pv = priority(v);
+    return pu < pv || (pu == pv && u < v);
+  }
+
+  // Adds `d` to the size of `u`'s root. Whoever links a root moves its size to the new root, so
+  // if `u` stopped being a root meanwhile, whatever is left behind is carried up.
+  void add_size(int u, int d) {
+    while (true) {
+      m_size[u] += d;
+      if (par[u] == u || (d = m_size[u].exchange(0)) == 0) {
+        return;
+      }
+      u = par[u];
+    }
+  }
+
+public:
+  concurrent_dsu(int n, std::uint64_t seed = std::random_device{}()) : seed(seed), par(n), m_size(n) {
+    for (int i = 0; i < n; ++i) {
+      par[i].store(i, std::memory_order_relaxed);
+      m_size[i].store(1, std::memory_order_relaxed);
+    }
+  }
+
+  /// @brief Returns the root of the component `u` is part of. Under concurrent merges this is a
+  /// root at some point during the call.
+  int root(int u) {
+    while (true) {
+      int p = par[u].load(std::memory_order_acquire);
+      if (p == u) {
+        return u;
+      }
+      int g = par[p].load(std::memory_order_acquire);
+      if (p != g) {
+        par[u].compare_exchange_weak(p, g, std::memory_order_release, std::memory_order_relaxed);
+      }
+      u = p;
+    }
+  }
+
+  /// @brief Merges the components `u` and `v` are part of.
+  /// @return Returns `true` if this call performed the merge and `false` if `u` and `v` were
+  /// already part of the same component.
+  bool merge(int u, int v) {
+    while (true) {
+      u = root(u), v = root(v);
+      if (u == v) {
+        return false;
+      }
+      if (!below(u, v)) {
+        std::swap(u, v);
+      }
+      int expected = u;
+      if (par[u].compare_exchange_strong(expected, v)) {
+        add_size(v, m_size[u].exchange(0));
+        return true;
+      }
+    }
+  }
+
+  /// @brief Merges along every edge in `edges`, splitting them across `ex`.
+  /// @return The number of merges performed.
+  template <executor Executor>
+  std::size_t merge(const std::vector<std::pair<int, int>> &edges, const Executor &ex) {
+    std::size_t parts = 4 * ex.concurrency(), width = (edges.size() + parts - 1) / parts;
+    std::atomic<std::size_t> merged = 0;
+    ex(parts, [&](std::size_t t) {
+      std::size_t cnt = 0;
+      for (std::size_t i = t * width; i < std::min(edges.size(), (t + 1) * width); ++i) {
+        cnt += merge(edges[i].first, edges[i].second);
+      }
+      merged += cnt;
+    });
+    return merged;
+  }
+
+  /// @brief Whether `u` and `v` are part of the same component at some point during the call.
+  bool same(int u, int v) {
+    while (true) {
+      u = root(u), v = root(v);
+      if (u == v) {
+        return true;
+      }
+      if (par[u] == u) {
+        return false;
+      }
+    }
+  }
+
+  /// @brief The size of `u`'s component; exact once no merges are in flight.
+  int size(int u) { return m_size[root(u)]; }
+};
+} // namespace algo
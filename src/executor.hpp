@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <thread>
+#include <vector>
+
+namespace algo {
+/// @brief Something that can run `tasks` independent tasks, `fn(0) ... fn(tasks - 1)`, and
+/// returns once all of them are done. `concurrency()` is how many of them may run at once.
+template <typename E>
+concept executor = requires(const E &ex, void (*fn)(std::size_t)) {
+  { ex.concurrency() } -> std::convertible_to<std::size_t>;
+  ex(std::size_t{}, fn);
+};
+
+/// @brief Runs every task on the calling thread, in order.
+struct serial_executor {
+  std::size_t concurrency() const { return 1; }
+
+  template <typename Fn>
+  void operator()(std::size_t tasks, Fn &&fn) const {
+    for (std::size_t i = 0; i < tasks; ++i) {
+      fn(i);
+    }
+  }
+};
+
+/// @brief Spreads tasks over up to `threads` threads (the calling thread included), which pick
+/// tasks off a shared counter and are joined before returning.
+struct thread_executor {
+  std::size_t threads;
+
+  thread_executor(std::size_t threads = std::max(1u, std::thread::hardware_concurrency())) : threads(threads) {}
+
+  std::size_t concurrency() const { return threads; }
+
+  template <typename Fn>
+  void operator()(std::size_t tasks, Fn &&fn) const {
+    std::atomic<std::size_t> next = 0;
+    auto work = [&] {
+      for (std::size_t i; (i = next++) < tasks;) {
+        fn(i);
+      }
+    };
+    std::vector<std::jthread> pool;
+    for (std::size_t t = 1; t < std::min(threads, tasks); ++t) {
+      pool.emplace_back(work);
+    }
+    work();
+  }
+};
+
+namespace internal {
+/// @brief Builds an implicit heap-ordered tree with `n` leaves (`n` a power of two): the tree is
+/// cut into one independent subtree per task, each task fills its leaves with `leaf(i)` and
+/// rebuilds its subtree bottom-up with `pull(i)`, then the few nodes above them are pulled on the
+/// calling thread.
+template <executor Executor, typename Leaf, typename Pull>
+void build_bottom_up(std::size_t n, const Executor &ex, Leaf &&leaf, Pull &&pull) {
+  std::size_t parts = std::min(n, std::bit_ceil(4 * ex.concurrency())), width = n / parts;
+  ex(parts, [&](std::size_t t) {
+    for (std::size_t i = t * width; i < (t + 1) * width; ++i) {
+      leaf(i);
+    }
+    for (std::size_t len = width / 2; len > 0; len /= 2) {
+      for (std::size_t i = (parts + t) * len; i < (parts + t + 1) * len; ++i) {
+        pull(i);
+      }
+    }
+  });
+  for (std::size_t i = parts - 1; i > 0; --i) {
+    pull(i);
+  }
+}
+} // namespace internal
+} // namespace algo
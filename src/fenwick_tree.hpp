@@ -1,5 +1,6 @@
 #pragma once
 
+#include <bit>
 #include <vector>
 
 namespace algo {
@@ -17,6 +18,17 @@ private:
 public:
   fenwick_tree(std::size_t n) : n(n), f(n + 1) {}
 
+  /// @brief Builds the tree over `vals` in `O(n)`: each node passes its total on to its parent.
+  template <typename M>
+  fenwick_tree(const std::vector<M> &vals) : n(vals.size()), f(n + 1) {
+    for (std::size_t i = 1; i <= n; ++i) {
+      f[i] = f[i] + T(vals[i - 1]);
+      if (std::size_t j = i + (i & -i); j <= n) {
+        f[j] = f[j] + f[i];
+      }
+    }
+  }
+
   /// @brief Applies `operator+` on each internal Fenwick node, essentially setting `a[i]` to `a[i]` + `x`
   /// @param i Index of the element to update.
   /// @param x The value to combine with `a[i]` using the monoid's associative `operator+`.
@@ -47,5 +59,20 @@ public:
   {
     return l == 0 ? query(r) : query(r) - query(l - 1);
   }
+
+  /// @brief Finds the first index whose prefix reaches `x`, by descending the tree once instead of
+  /// binary searching over `query`. Prefixes must be non-decreasing (e.g. non-negative counts).
+  /// @return The smallest `i` with `!(query(i) < x)`, or `n` if there is none.
+  std::size_t lower_bound(const T &x) const {
+    std::size_t pos = 0;
+    T acc = T{};
+    for (std::size_t k = std::bit_floor(n); k > 0; k >>= 1) {
+      if (pos + k <= n && acc + f[pos + k] < x) {
+        pos += k;
+        acc = acc + f[pos];
+      }
+    }
+    return pos;
+  }
 };
 } // namespace algo
\ No newline at end of file
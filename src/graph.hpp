@@ -1,8 +1,10 @@
 #pragma once
 
 #include <algorithm>
-#include <queue>
+#include <limits>
+#include <span>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace algo {
@@ -15,14 +17,74 @@ class graph {
 private:
   std::size_t n;
   std::vector<std::vector<T>> adj;
+  // Once frozen, the out-neighbours of `u` are
+  // `targets[offset[u]] ... targets[offset[u + 1] - 1]`.
+  std::vector<std::size_t> offset;
+  std::vector<T> targets;
+
+  bool frozen() const { return !offset.empty(); }
+
+  void thaw() {
+    adj.assign(n, {});
+    for (std::size_t u = 0; u < n; ++u) {
+      adj[u].assign(targets.begin() + offset[u], targets.begin() + offset[u + 1]);
+    }
+    offset.clear(), offset.shrink_to_fit();
+    targets.clear(), targets.shrink_to_fit();
+  }
 
 public:
   graph(std::size_t n) : n(n), adj(n) {}
 
+  /// @brief Builds a frozen graph straight from its directed edges with a counting sort, without
+  /// ever allocating a list per vertex.
+  graph(std::size_t n, const std::vector<std::pair<T, T>> &edges) : n(n), offset(n + 1), targets(edges.size()) {
+    for (const auto &[u, v] : edges) {
+      ++offset[u + 1];
+    }
+    for (std::size_t u = 0; u < n; ++u) {
+      offset[u + 1] += offset[u];
+    }
+    std::vector<std::size_t> pos(offset.begin(), offset.end() - 1);
+    for (const auto &[u, v] : edges) {
+      targets[pos[u]++] = v;
+    }
+  }
+
+  std::size_t size() const { return n; }
+
   void add_edge(const T &u, const T &v) {
+    if (frozen()) {
+      thaw();
+    }
     adj[u].push_back(v);
   }
 
+  /// @brief Packs the adjacency lists into two flat arrays (compressed sparse row): one offset per
+  /// vertex and all out-neighbours back to back. Adding an edge afterwards unpacks them again.
+  void freeze() {
+    if (frozen()) {
+      return;
+    }
+    offset.assign(n + 1, 0);
+    for (std::size_t u = 0; u < n; ++u) {
+      offset[u + 1] = offset[u] + adj[u].size();
+    }
+    targets.resize(offset[n]);
+    for (std::size_t u = 0; u < n; ++u) {
+      std::copy(adj[u].begin(), adj[u].end(), targets.begin() + offset[u]);
+    }
+    std::vector<std::vector<T>>().swap(adj);
+  }
+
+  /// @brief Returns the out-neighbours of `u`.
+  std::span<const T> neighbors(const T &u) const {
+    if (frozen()) {
+      return {targets.data() + offset[u], targets.data() + offset[u + 1]};
+    }
+    return adj[u];
+  }
+
   struct bfs_result {
     std::vector<int> dist;
     std::vector<T> par;
@@ -35,21 +97,18 @@ public:
   /// @param start The starting node for the BFS traversal.
   /// @return A struct `bfs_result` object containing two `std::vector`s
   bfs_result bfs(const T &start) const {
-    std::queue<T> q;
-    std::vector<bool> vis(n);
     bfs_result ans(n);
     ans.dist.assign(n, std::numeric_limits<int>::max());
     ans.par.assign(n, -1);
-    q.push(start);
+    std::vector<T> q{start};
+    q.reserve(n);
     ans.dist[start] = 0, ans.par[start] = start;
-    while (!q.empty()) {
-      T u = q.front();
-      q.pop();
-      for (const T &v : adj[u]) {
-        if (!vis[v]) {
-          vis[v] = true;
+    for (std::size_t head = 0; head < q.size(); ++head) {
+      T u = q[head];
+      for (const T &v : neighbors(u)) {
+        if (ans.par[v] == -1) {
           ans.par[v] = u, ans.dist[v] = ans.dist[u] + 1;
-          q.push(v);
+          q.push_back(v);
         }
       }
     }
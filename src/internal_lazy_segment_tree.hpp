@@ -1,8 +1,13 @@
 #pragma once
 
+#include "executor.hpp"
 #include "lazy_traits.hpp"
 #include "monoid.hpp"
+#include <algorithm>
 #include <bit>
+#include <functional>
+#include <span>
+#include <tuple>
 #include <vector>
 
 namespace algo {
@@ -63,6 +68,58 @@ private:
     }
   }
 
+  // Puts the tags of `ups` on their canonical nodes and pulls every affected ancestor once. The
+  // tags must commute with each other; unless `push_spines` is set, they must also commute with
+  // the tags already in the tree, since the boundary spines are then left as they are.
+  void apply_commuting(std::span<const std::tuple<std::size_t, std::size_t, F>> ups, bool push_spines) {
+    std::vector<std::size_t> bounds;
+    bounds.reserve(2 * ups.size());
+    for (const auto &[ql, qr, x] : ups) {
+      bounds.push_back(ql + n);
+      bounds.push_back(qr + n + 1);
+    }
+    std::sort(bounds.begin(), bounds.end());
+    if (push_spines) {
+      // The same nodes as `push_all` on every update, top-down one level at a time; duplicates are
+      // adjacent, so each ancestor is pushed once.
+      for (int i = h; i > 0; --i) {
+        std::size_t last = 0;
+        for (std::size_t b : bounds) {
+          std::size_t v = b >> i;
+          if ((v << i) != b && v != last) {
+            push(v, 1 << i);
+            last = v;
+          }
+        }
+      }
+    }
+    for (const auto &[ql, qr, x] : ups) {
+      for (std::size_t i = ql + n, j = qr + n + 1, len = 1; i < j; i >>= 1, j >>= 1, len <<= 1) {
+        if (i & 1)
+          apply_to(i++, x, len);
+        if (j & 1)
+          apply_to(--j, x, len);
+      }
+    }
+    // Walk the ancestors of all boundaries up one level at a time; sorted boundaries keep their
+    // ancestors sorted, so duplicates are adjacent and the list shrinks as the spines meet. Tags
+    // above a pulled node were never pushed, so the node's own tag is re-applied after the pull.
+    for (int i = 1; i <= h; ++i) {
+      std::size_t m = 0;
+      for (std::size_t k = 0; k < bounds.size(); ++k) {
+        std::size_t v = bounds[k] >> 1;
+        if ((m == 0 || bounds[m - 1] != v) && v < (n >> (i - 1))) {
+          bounds[m++] = v;
+        }
+      }
+      bounds.resize(m);
+      for (std::size_t v : bounds) {
+        pull(v);
+        traits::apply(seg[v], tag[v], 1 << i);
+      }
+    }
+  }
+
 public:
   lazy_segment_tree(std::size_t _n) : _n(_n), n(std::bit_ceil(_n)), h(std::countr_zero(n)), seg(2 * n), tag(n) {}
   lazy_segment_tree(std::size_t _n, T x) : _n(_n), n(std::bit_ceil(_n)), h(std::countr_zero(n)), seg(2 * n), tag(n) {
@@ -81,6 +138,21 @@ public:
     tag.assign(n, F{});
   }
 
+  /// @brief Bulk-assigns values to all leaves, rebuilding independent subtrees in parallel on
+  /// `ex` before the short serial pass over the top of the tree.
+  template <typename M, executor Executor>
+  void set(const std::vector<M> &vals, const Executor &ex) {
+    tag.assign(n, F{});
+    internal::build_bottom_up(
+        n, ex,
+        [&](std::size_t i) {
+          if (i < _n) {
+            seg[n + i] = vals[i];
+          }
+        },
+        [&](std::size_t i) { pull(i); });
+  }
+
   void apply(std::size_t l, std::size_t r, F x) {
     push_all(l += n, r += n + 1);
     for (std::size_t i = l, j = r, len = 1; i < j; i >>= 1, j >>= 1, len <<= 1) {
@@ -96,6 +168,30 @@ public:
     apply(i, i, x);
   }
 
+  /// @brief Applies a burst of range updates. When `traits` declares its tags commutative, no
+  /// spine is pushed: the tags land on the canonical nodes, the update boundaries are sorted, and
+  /// every affected ancestor is pulled exactly once, level by level. Otherwise the order of the
+  /// tags matters and each update is applied on its own, so traits like affine maps gain nothing.
+  /// @param ups Updates `(l, r, x)`, each applying `x` to the inclusive range `[l, r]`.
+  void apply_batch(std::span<const std::tuple<std::size_t, std::size_t, F>> ups) {
+    if constexpr (has_commutative_tags<traits>) {
+      apply_commuting(ups, false);
+    } else {
+      for (const auto &[l, r, x] : ups) {
+        apply(l, r, x);
+      }
+    }
+  }
+
+  /// @brief Applies a burst of range updates whose tags commute with each other, though not
+  /// necessarily with the tags already in the tree, such as adds to a tree that also takes
+  /// assignments. The boundary spines are pushed first; every affected ancestor is pushed and
+  /// pulled only once.
+  /// @param ups Updates `(l, r, x)`, each applying `x` to the inclusive range `[l, r]`.
+  void apply_commuting_batch(std::span<const std::tuple<std::size_t, std::size_t, F>> ups) {
+    apply_commuting(ups, true);
+  }
+
   T query(std::size_t l, std::size_t r) {
     push_all(l += n, r += n + 1);
     T ans_l = base, ans_r = base;
@@ -109,7 +205,38 @@ public:
     return op(ans_l, ans_r);
   }
 
+  /// @brief Read-only accumulation over `[l, r]`: pending tags are not pushed but composed on the
+  /// way up, so neither `seg` nor `tag` is written. Any number of threads may query a shared
+  /// (const) snapshot concurrently, as long as no thread modifies that same snapshot meanwhile.
+  /// @param l The left endpoint (inclusive) of the range to accumulate.
+  /// @param r The right endpoint (inclusive) of the range to accumulate.
+  /// @return Returns the accumulated result of [l, r].
+  T query(std::size_t l, std::size_t r) const {
+    // Everything gathered on the left so far lies below the ancestor `pl >> 1` of the leaf just
+    // before the range, and everything on the right below the ancestor `pr >> 1` of the leaf just
+    // after it, so those ancestors' tags are exactly the ones still pending for the partial sums.
+    T ans_l = base, ans_r = base;
+    int cnt_l = 0, cnt_r = 0;
+    l += n, r += n + 1;
+    for (std::size_t pl = l - 1, pr = r, len = 1; len <= n; l >>= 1, r >>= 1, pl >>= 1, pr >>= 1, len <<= 1) {
+      if (l < r) {
+        if (l & 1)
+          ans_l = op(ans_l, seg[l++]), cnt_l += len;
+        if (r & 1)
+          ans_r = op(seg[--r], ans_r), cnt_r += len;
+      }
+      if (len < n) {
+        if (cnt_l)
+          traits::apply(ans_l, tag[pl >> 1], cnt_l);
+        if (cnt_r)
+          traits::apply(ans_r, tag[pr >> 1], cnt_r);
+      }
+    }
+    return op(ans_l, ans_r);
+  }
+
   T at(std::size_t i) { return query(i, i); }
+  T at(std::size_t i) const { return query(i, i); }
 
   std::size_t size() const { return _n; }
 };
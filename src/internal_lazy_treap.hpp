@@ -2,23 +2,33 @@
 
 #include "lazy_traits.hpp"
 #include "monoid.hpp"
+#include "node_pool.hpp"
 #include <random>
+#include <ranges>
 #include <utility>
+#include <vector>
 
 namespace algo {
 namespace internal {
-template <typename T, typename f = std::plus<>, T base = monoid_identity<T, f>::x, typename F = T, typename traits = lazy_traits<T, F, f>>
+template <typename T, typename f = std::plus<>, typename Id = monoid_identity<T, f>, typename F = T, typename traits = lazy_traits<T, F, f>, typename Nodes = heap_nodes>
 class lazy_treap {
 private:
   static inline std::mt19937 gen{std::random_device{}()};
 
+  struct node;
+  using pool = typename Nodes::template pool<node>;
+  using ptr = typename pool::ptr;
+  static constexpr ptr null = pool::null;
+
   struct node {
-    int64_t s, p;
-    node *l, *r;
+    int64_t s;
+    uint32_t p;
+    ptr l, r;
     T x, a;
     F t;
     bool rev;
-    node(const T &_x) : s(1), p(gen()), l(nullptr), r(nullptr), x(_x), a(_x), t(F{}), rev(false) {}
+    node() : s(0), p(gen()), l(null), r(null), x(T{}), a(T{}), t(F{}), rev(false) {}
+    node(const T &_x) : s(1), p(gen()), l(null), r(null), x(_x), a(_x), t(F{}), rev(false) {}
   };
 
   T op(const T &a, const T &b) const {
@@ -29,153 +39,184 @@ private:
     }
   }
 
-  node *root;
+  // Keeps the pool alive for as long as this container.
+  [[no_unique_address]] typename pool::lifetime lifetime;
+  ptr root;
 
-  void destruct(node *n) {
-    if (n) {
-      destruct(n->l);
-      destruct(n->r);
-      delete n;
+  // The nodes visited by the last walk, pulled bottom-up once it is done.
+  static inline std::vector<ptr> path;
+
+  static node &get(ptr n) { return pool::get(n); }
+
+  // Rotates left children up until there are none, freeing nodes as they come off the top.
+  void destruct(ptr n) {
+    while (n) {
+      if (ptr l = get(n).l) {
+        get(n).l = get(l).r;
+        get(l).r = n;
+        n = l;
+      } else {
+        pool::free(std::exchange(n, get(n).r));
+      }
     }
   }
 
-  int64_t s(node *n) const { return n ? n->s : 0; }
-  T a(node *n) { return n ? n->a : base; }
+  int64_t s(ptr n) const { return n ? get(n).s : 0; }
+  T a(ptr n) { return n ? get(n).a : Id{}(); }
 
-  void flip(node *n) {
+  void flip(ptr n) {
     if (n) {
-      n->rev ^= 1;
+      get(n).rev ^= 1;
     }
   }
 
-  void __apply(node *n, const F &t) {
+  void __apply(ptr n, const F &t) {
     if constexpr (!std::is_void_v<traits>) {
       if (n) {
-        traits::apply(n->x, t, 1);
-        traits::apply(n->a, t, n->s);
-        n->t = n->t + t;
+        traits::apply(get(n).x, t, 1);
+        traits::apply(get(n).a, t, get(n).s);
+        get(n).t = get(n).t + t;
       }
     }
   }
 
-  void pull_rev(node *n) {
+  void pull_rev(ptr n) {
     if (!n) {
       return;
     }
-    if (n->rev) {
-      std::swap(n->l, n->r);
-      flip(n->l);
-      flip(n->r);
-      n->rev = false;
-      traits::reverse(n->a);
+    if (get(n).rev) {
+      std::swap(get(n).l, get(n).r);
+      flip(get(n).l);
+      flip(get(n).r);
+      get(n).rev = false;
+      traits::reverse(get(n).a);
     }
   }
 
-  void push(node *n) {
+  void push(ptr n) {
     if (!n) {
       return;
     }
     pull_rev(n);
-    __apply(n->l, n->t);
-    __apply(n->r, n->t);
-    n->t = F{};
+    __apply(get(n).l, get(n).t);
+    __apply(get(n).r, get(n).t);
+    get(n).t = F{};
   }
 
-  node *pull(node *n) {
+  ptr pull(ptr n) {
     if (!n) {
       return n;
     }
-    pull_rev(n->l);
-    pull_rev(n->r);
-    n->s = s(n->l) + s(n->r) + 1;
-    n->a = op(op(a(n->l), n->x), a(n->r));
+    pull_rev(get(n).l);
+    pull_rev(get(n).r);
+    get(n).s = s(get(n).l) + s(get(n).r) + 1;
+    get(n).a = op(op(a(get(n).l), get(n).x), a(get(n).r));
     return n;
   }
 
-  node *build(const std::vector<T> &a) {
-    std::vector<node *> st;
-    st.reserve(a.size());
-    node *root = nullptr;
+
+  void pull_path() {
+    for (std::size_t k = path.size(); k-- > 0;) {
+      pull(path[k]);
+    }
+    path.clear();
+  }
+
+  // Builds a Cartesian tree in one left-to-right pass, keeping its right spine in `path`. Lower
+  // priorities go on top, matching `merge`.
+  template <typename R>
+  ptr build(R &&a) {
+    ptr root = null;
     for (const T &x : a) {
-      node *cur = new node(x);
-      node *prev = nullptr;
-      while (!st.empty() && st.back()->p < cur->p) {
-        prev = st.back();
-        st.pop_back();
+      ptr cur = pool::make(x);
+      ptr prev = null;
+      while (!path.empty() && get(cur).p < get(path.back()).p) {
+        prev = path.back();
+        path.pop_back();
         pull(prev);
       }
-      cur->l = prev;
-      if (!st.empty()) {
-        st.back()->r = cur;
+      get(cur).l = prev;
+      if (!path.empty()) {
+        get(path.back()).r = cur;
       } else {
         root = cur;
       }
-      st.push_back(cur);
-    }
-    for (int i = st.size() - 1; i >= 0; --i) {
-      pull(st[i]);
+      path.push_back(cur);
     }
+    pull_path();
     return root;
   }
 
-  std::pair<node *, node *> split(node *n, int64_t i) { // split into [0...i] [i+1,n-1]
-    if (!n) {
-      return {nullptr, nullptr};
-    }
+  // Walks down once, hanging each node off the right spine of the left part or the left spine of
+  // the right part; `lh` and `rh` are the child slots where the next node of each part goes.
+  std::pair<ptr, ptr> split(ptr n, int64_t i) { // split into [0...i] [i+1,n-1]
     if (i < 0) {
-      return {nullptr, n};
-    }
-    push(n);
-    if (i == s(n->l)) {
-      node *r = std::exchange(n->r, nullptr);
-      return {pull(n), r};
+      return {null, n};
     }
-    if (i < s(n->l)) {
-      auto [l, r] = split(std::exchange(n->l, nullptr), i);
-      return {l, merge(r, pull(n))};
+    ptr l = null, r = null, *lh = &l, *rh = &r;
+    while (n) {
+      push(n);
+      path.push_back(n);
+      node &d = get(n);
+      if (int64_t ls = s(d.l); i >= ls) {
+        i -= ls + 1;
+        *lh = n;
+        lh = &d.r;
+        n = d.r;
+      } else {
+        *rh = n;
+        rh = &d.l;
+        n = d.l;
+      }
     }
-    auto [l, r] = split(std::exchange(n->r, nullptr), i - s(n->l) - 1);
-    return {merge(pull(n), l), r};
+    *lh = *rh = null;
+    pull_path();
+    return {l, r};
   }
 
-  node *merge(node *l, node *r) {
-    if (!l) {
-      return r;
-    }
-    if (!r) {
-      return l;
-    }
-    if (l->p < r->p) {
-      push(l);
-      l->r = merge(l->r, r);
-      return pull(l);
+  // Zips the right spine of `l` with the left spine of `r` by priority.
+  ptr merge(ptr l, ptr r) {
+    ptr m = null, *h = &m;
+    while (l && r) {
+      if (get(l).p < get(r).p) {
+        push(l);
+        path.push_back(*h = l);
+        h = &get(l).r;
+        l = get(l).r;
+      } else {
+        push(r);
+        path.push_back(*h = r);
+        h = &get(r).l;
+        r = get(r).l;
+      }
     }
-    push(r);
-    r->l = merge(l, r->l);
-    return pull(r);
+    *h = l ? l : r;
+    pull_path();
+    return m;
   }
 
-  node *insert(node *n, int64_t i, const T &x) {
+  ptr insert(ptr n, int64_t i, const T &x) {
     auto [l, r] = split(n, i - 1);
-    return merge(merge(l, new node(x)), r);
+    return merge(merge(l, pool::make(x)), r);
   }
 
-  node *erase(node *n, int64_t i) {
+  ptr erase(ptr n, int64_t i) {
     auto [l, r1] = split(n, i - 1);
     auto [m, r] = split(r1, 0);
-    delete m;
+    pool::free(m);
     return merge(l, r);
   }
 
-  T at(node *n, int64_t i) {
-    push(n);
-    if (i == s(n->l)) {
-      return n->x;
-    }
-    if (i < s(n->l)) {
-      return at(n->l, i);
+  T at(ptr n, int64_t i) {
+    for (push(n); i != s(get(n).l); push(n)) {
+      if (i < s(get(n).l)) {
+        n = get(n).l;
+      } else {
+        i -= s(get(n).l) + 1;
+        n = get(n).r;
+      }
     }
-    return at(n->r, i - s(n->l) - 1);
+    return get(n).x;
   }
 
   T _query(int64_t l, int64_t r) {
@@ -197,15 +238,15 @@ private:
     auto [l1, r1] = split(root, l - 1);
     auto [l2, r2] = split(r1, r - l);
     if (l2) {
-      l2->rev ^= 1;
+      get(l2).rev ^= 1;
     }
     root = merge(merge(l1, l2), r2);
   }
 
-  lazy_treap(node *n) : root(n) {}
+  lazy_treap(ptr n) : root(n) {}
 
 public:
-  lazy_treap() : root(nullptr) {}
+  lazy_treap() : root(null) {}
   lazy_treap(const std::vector<T> &a) { root = build(a); }
   lazy_treap(std::size_t n, const T &x) {
     std::vector<T> a(n, x);
@@ -218,11 +259,11 @@ public:
   lazy_treap(const lazy_treap &) = delete;
   lazy_treap &operator=(const lazy_treap &) = delete;
   lazy_treap(lazy_treap &&other) noexcept
-      : root(std::exchange(other.root, nullptr)) {}
+      : root(std::exchange(other.root, null)) {}
   lazy_treap &operator=(lazy_treap &&other) noexcept {
     if (this != &other) {
       destruct(root);
-      root = std::exchange(other.root, nullptr);
+      root = std::exchange(other.root, null);
     }
     return *this;
   }
@@ -239,6 +280,10 @@ public:
     merge(r);
   }
 
+  template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, T>
+  void append(R &&a) { root = merge(root, build(a)); }
+
   void erase(std::size_t i) { root = erase(root, i); }
 
   T at(std::size_t i) { return at(root, i); }
@@ -266,7 +311,7 @@ public:
 
   void merge(lazy_treap &other) {
     root = merge(root, other.root);
-    other.root = nullptr;
+    other.root = null;
   }
   void merge(lazy_treap &&other) { merge(other); }
 
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "line.hpp"
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace algo {
+/// @brief A kinetic segment tree: an array of linear functions `f_i(t)`, answering range maxima
+/// (or, with `std::less<>`, minima) at a global time `t` that only moves forward. Every node keeps
+/// its winning leaf and the earliest time at which a loser below it can overtake; advancing time
+/// only revisits nodes whose time has come, for amortised `O(log^2 n)` per update.
+template <typename T, typename Comp = std::greater<>>
+class kinetic_segment_tree {
+private:
+  static constexpr T inf = std::numeric_limits<T>::max();
+  static constexpr int none = -1;
+
+  std::size_t _n, n;
+  T t;
+  std::vector<line<T>> lines;
+  std::vector<int> best;
+  std::vector<T> melt;
+
+  // Whether leaf `a` wins over leaf `b` at the current time, ties going to the line that will win
+  // afterwards.
+  bool wins(int a, int b) const {
+    T fa = lines[a](t), fb = lines[b](t);
+    if (fa != fb) {
+      return Comp{}(fa, fb);
+    }
+    return !Comp{}(lines[b].slope(), lines[a].slope());
+  }
+
+  // The first time after the current one at which `b` beats `a`, which wins now.
+  T overtake(int a, int b) const {
+    if (!Comp{}(lines[b].slope(), lines[a].slope())) {
+      return inf;
+    }
+    T dm = lines[b].slope() - lines[a].slope();
+    T db = lines[a].intercept() - lines[b].intercept();
+    if constexpr (std::is_integral_v<T>) {
+      // The lines meet at `db / dm`; round it up.
+      return db / dm + (db % dm != 0 && (db < 0) == (dm < 0));
+    } else {
+      return db / dm;
+    }
+  }
+
+  void pull(std::size_t i) {
+    int a = best[2 * i], b = best[2 * i + 1];
+    melt[i] = std::min(melt[2 * i], melt[2 * i + 1]);
+    if (a == none || b == none) {
+      best[i] = a == none ? b : a;
+      return;
+    }
+    if (!wins(a, b)) {
+      std::swap(a, b);
+    }
+    best[i] = a;
+    melt[i] = std::min(melt[i], overtake(a, b));
+  }
+
+  void heaten(std::size_t i) {
+    // Leaves never melt.
+    if (melt[i] > t) {
+      return;
+    }
+    heaten(2 * i);
+    heaten(2 * i + 1);
+    pull(i);
+  }
+
+public:
+  /// @brief Builds the tree over `fs` at time `t0`.
+  kinetic_segment_tree(const std::vector<line<T>> &fs, T t0 = T{})
+      : _n(fs.size()), n(std::bit_ceil(std::max<std::size_t>(_n, 1))), t(t0), lines(fs), best(2 * n, none), melt(2 * n, inf) {
+    for (std::size_t i = 0; i < _n; ++i) {
+      best[n + i] = i;
+    }
+    for (std::size_t i = n - 1; i > 0; --i) {
+      pull(i);
+    }
+  }
+  /// @brief An empty tree with `_n` slots at time `t0`.
+  kinetic_segment_tree(std::size_t _n, T t0 = T{})
+      : _n(_n), n(std::bit_ceil(std::max<std::size_t>(_n, 1))), t(t0), lines(_n), best(2 * n, none), melt(2 * n, inf) {}
+
+  /// @brief Places `f` at index `i`.
+  void set(std::size_t i, const line<T> &f) {
+    lines[i] = f;
+    best[n + i] = i;
+    for (i = (n + i) / 2; i > 0; i /= 2) {
+      pull(i);
+    }
+  }
+
+  /// @brief Removes the function at index `i`.
+  void reset(std::size_t i) {
+    best[n + i] = none;
+    for (i = (n + i) / 2; i > 0; i /= 2) {
+      pull(i);
+    }
+  }
+
+  /// @brief Moves time forward to `_t`, which must not be before the current time.
+  void advance(T _t) {
+    t = _t;
+    heaten(1);
+  }
+
+  T time() const { return t; }
+
+  /// @brief The best value at the current time over [l, r], if any index in it holds a function.
+  std::optional<T> query(std::size_t l, std::size_t r) const {
+    std::optional<T> ans;
+    auto take = [&](std::size_t i) {
+      if (best[i] != none) {
+        T v = lines[best[i]](t);
+        if (!ans || Comp{}(v, *ans)) {
+          ans = v;
+        }
+      }
+    };
+    for (l += n, r += n + 1; l < r; l /= 2, r /= 2) {
+      if (l & 1) {
+        take(l++);
+      }
+      if (r & 1) {
+        take(--r);
+      }
+    }
+    return ans;
+  }
+
+  std::size_t size() const { return _n; }
+};
+} // namespace algo
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace algo {
 namespace internal {
 template <typename F>
@@ -23,7 +25,7 @@ struct lazy_add_set_op {
 
 template <typename T, typename F, typename traits>
 struct lazy_add_set_combine {
-  static void apply(T &a, const lazy_add_set_op<F> &f, int len) {
+  static void apply(T &a, const lazy_add_set_op<F> &f, int64_t len) {
     if (f.has_set) {
       traits::set(a, f.set, len);
     } else {
@@ -20,6 +20,8 @@ public:
 
   template <typename M>
   void set(const std::vector<M> &vals) { st.set(vals); }
+  template <typename M, executor Executor>
+  void set(const std::vector<M> &vals, const Executor &ex) { st.set(vals, ex); }
 
   void add(std::size_t l, std::size_t r, F x) {
     st.apply(l, r, {x, F{}, false});
@@ -28,6 +30,18 @@ public:
   void apply(std::size_t l, std::size_t r, F x) { add(l, r, x); }
   void apply(std::size_t i, F x) { apply(i, i, x); }
 
+  /// @brief Adds to a burst of ranges at once. Adds commute with each other, so every affected
+  /// ancestor is pulled only once; see `internal::lazy_segment_tree::apply_commuting_batch`.
+  /// @param ups Updates `(l, r, x)`, each adding `x` to the inclusive range `[l, r]`.
+  void apply_batch(std::span<const std::tuple<std::size_t, std::size_t, F>> ups) {
+    std::vector<std::tuple<std::size_t, std::size_t, lazy_op>> ops;
+    ops.reserve(ups.size());
+    for (const auto &[l, r, x] : ups) {
+      ops.emplace_back(l, r, lazy_op{x, F{}, false});
+    }
+    st.apply_commuting_batch(ops);
+  }
+
   void set(std::size_t l, std::size_t r, F x) {
     st.apply(l, r, {F{}, x, true});
   }
@@ -36,8 +50,12 @@ public:
   T query(std::size_t l, std::size_t r) {
     return st.query(l, r);
   }
+  T query(std::size_t l, std::size_t r) const {
+    return st.query(l, r);
+  }
 
   T at(std::size_t i) { return st.query(i, i); }
+  T at(std::size_t i) const { return st.query(i, i); }
   reference operator[](std::size_t i) { return reference(this, i); }
   reference front() { return reference(this, 0); }
   reference back() { return reference(this, size() - 1); }
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "lazy_op.hpp"
+#include "lazy_traits.hpp"
+#include "monoid.hpp"
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace algo {
+namespace internal {
+/// @brief A lazy segment tree over a huge index range, with nodes created on demand in one arena
+/// and linked by 32-bit indices. Untouched indices hold the identity, so tags must be well-defined
+/// on it (e.g. sums, or assigning before adding with min/max).
+template <typename T, typename f = std::plus<>, typename Id = monoid_identity<T, f>, typename F = T, typename traits = lazy_traits<T, F, f>>
+class lazy_sparse_segment_tree {
+private:
+  struct node {
+    T val;
+    F tag;
+    std::uint32_t l, r;
+    bool tagged;
+  };
+
+  int64_t s, e;
+  std::vector<node> nodes;
+
+  T op(const T &a, const T &b) const {
+    if constexpr (std::is_same_v<std::invoke_result_t<f &, T, T>, bool>) {
+      return f{}(a, b) ? a : b;
+    } else {
+      return f{}(a, b);
+    }
+  }
+
+  T base() const { return Id{}(); }
+
+  std::uint32_t make() {
+    nodes.push_back({base(), F{}, 0, 0, false});
+    return nodes.size() - 1;
+  }
+
+  void apply_to(std::uint32_t t, const F &x, int64_t len) {
+    node &n = nodes[t];
+    traits::apply(n.val, x, len);
+    n.tag = n.tagged ? n.tag + x : x;
+    n.tagged = true;
+  }
+
+  void push(std::uint32_t t, int64_t lo, int64_t hi) {
+    if (!nodes[t].tagged) {
+      return;
+    }
+    if (!nodes[t].l) {
+      std::uint32_t c = make();
+      nodes[t].l = c;
+    }
+    if (!nodes[t].r) {
+      std::uint32_t c = make();
+      nodes[t].r = c;
+    }
+    int64_t m = std::midpoint(lo, hi);
+    F x = nodes[t].tag;
+    apply_to(nodes[t].l, x, m - lo + 1);
+    apply_to(nodes[t].r, x, hi - m);
+    nodes[t].tag = F{};
+    nodes[t].tagged = false;
+  }
+
+  void pull(std::uint32_t t) {
+    node &n = nodes[t];
+    n.val = op(n.l ? nodes[n.l].val : base(), n.r ? nodes[n.r].val : base());
+  }
+
+  void apply(std::uint32_t t, int64_t lo, int64_t hi, int64_t l, int64_t r, const F &x) {
+    if (l <= lo && hi <= r) {
+      apply_to(t, x, hi - lo + 1);
+      return;
+    }
+    push(t, lo, hi);
+    int64_t m = std::midpoint(lo, hi);
+    if (l <= m) {
+      if (!nodes[t].l) {
+        std::uint32_t c = make();
+        nodes[t].l = c;
+      }
+      apply(nodes[t].l, lo, m, l, r, x);
+    }
+    if (m < r) {
+      if (!nodes[t].r) {
+        std::uint32_t c = make();
+        nodes[t].r = c;
+      }
+      apply(nodes[t].r, m + 1, hi, l, r, x);
+    }
+    pull(t);
+  }
+
+  T query(std::uint32_t t, int64_t lo, int64_t hi, int64_t l, int64_t r) {
+    if (t == 0 || r < lo || hi < l) {
+      return base();
+    }
+    if (l <= lo && hi <= r) {
+      return nodes[t].val;
+    }
+    push(t, lo, hi);
+    int64_t m = std::midpoint(lo, hi);
+    return op(query(nodes[t].l, lo, m, l, r), query(nodes[t].r, m + 1, hi, l, r));
+  }
+
+public:
+  lazy_sparse_segment_tree(int64_t l, int64_t r) : s(l), e(r) {
+    nodes.push_back({base(), F{}, 0, 0, false});
+    make();
+  }
+  lazy_sparse_segment_tree(std::size_t n) : lazy_sparse_segment_tree(0, int64_t(n) - 1) {}
+
+  void reserve(std::size_t n) { nodes.reserve(nodes.size() + n); }
+
+  void apply(int64_t l, int64_t r, const F &x) { apply(1, s, e, l, r, x); }
+  void apply(int64_t i, const F &x) { apply(i, i, x); }
+
+  T query(int64_t l, int64_t r) { return query(1, s, e, l, r); }
+  T at(int64_t i) { return query(i, i); }
+
+  std::size_t size() const { return e - s + 1; }
+  std::size_t node_count() const { return nodes.size() - 1; }
+};
+} // namespace internal
+
+template <typename T, typename f = std::plus<>, typename Id = monoid_identity<T, f>, typename F = T, typename traits = lazy_traits<T, F, f>>
+class lazy_add_set_sparse_segment_tree {
+private:
+  using lazy_op = internal::lazy_add_set_op<F>;
+  using combine = internal::lazy_add_set_combine<T, F, traits>;
+
+  internal::lazy_sparse_segment_tree<T, f, Id, lazy_op, combine> st;
+
+public:
+  lazy_add_set_sparse_segment_tree(int64_t l, int64_t r) : st(l, r) {}
+  lazy_add_set_sparse_segment_tree(std::size_t n) : st(n) {}
+
+  void reserve(std::size_t n) { st.reserve(n); }
+
+  void add(int64_t l, int64_t r, F x) { st.apply(l, r, {x, F{}, false}); }
+  void add(int64_t i, F x) { add(i, i, x); }
+  void apply(int64_t l, int64_t r, F x) { add(l, r, x); }
+  void apply(int64_t i, F x) { apply(i, i, x); }
+
+  void set(int64_t l, int64_t r, F x) { st.apply(l, r, {F{}, x, true}); }
+  void set(int64_t i, F x) { set(i, i, x); }
+
+  T query(int64_t l, int64_t r) { return st.query(l, r); }
+  T at(int64_t i) { return st.at(i); }
+
+  std::size_t size() const { return st.size(); }
+  std::size_t node_count() const { return st.node_count(); }
+};
+
+/// @brief A lazy segment tree over a range too large to allocate, such as [0, 10^18); only nodes
+/// touched by updates exist.
+template <typename T, typename f = std::plus<>, typename Id = monoid_identity<T, f>, typename F = T, typename traits = lazy_traits<T, F, f>>
+using lazy_sparse_segment_tree =
+    std::conditional_t<
+        has_set_trait<traits, T, F>,
+        lazy_add_set_sparse_segment_tree<T, f, Id, F, traits>,
+        internal::lazy_sparse_segment_tree<T, f, Id, F, traits>>;
+} // namespace algo
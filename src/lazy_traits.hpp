@@ -1,6 +1,7 @@
 #pragma once
 
 #include "traits.hpp"
+#include <cstdint>
 #include <functional>
 
 namespace algo {
@@ -9,39 +10,49 @@ struct lazy_traits;
 
 template <typename T, typename F>
 struct lazy_traits<T, F, std::plus<>> {
-  static void apply(T &a, const F &f, int len) {
+  static void apply(T &a, const F &f, int64_t len) {
     a += f * len;
   }
-  static void set(T &a, const F &f, int len) {
+  static void set(T &a, const F &f, int64_t len) {
     a = f * len;
   }
   static void reverse(T &) {}
+  static constexpr bool commutative = true;
 };
 
 template <typename T, typename F>
 struct lazy_traits<T, F, std::greater<>> {
-  static void apply(T &a, const F &f, int) {
+  static void apply(T &a, const F &f, int64_t) {
     a += f;
   }
-  static void set(T &a, const F &f, int) {
+  static void set(T &a, const F &f, int64_t) {
     a = f;
   }
   static void reverse(T &) {}
+  static constexpr bool commutative = true;
 };
 
 template <typename T, typename F>
 struct lazy_traits<T, F, std::less<>> {
-  static void apply(T &a, const F &f, int) {
+  static void apply(T &a, const F &f, int64_t) {
     a += f;
   }
-  static void set(T &a, const F &f, int) {
+  static void set(T &a, const F &f, int64_t) {
     a = f;
   }
   static void reverse(T &) {}
+  static constexpr bool commutative = true;
+};
+
+/// @brief Whether applying tags in any order gives the same result, as with plain additions.
+/// Traits opt in with `static constexpr bool commutative = true;`.
+template <typename traits>
+concept has_commutative_tags = requires {
+  requires traits::commutative;
 };
 
 template <typename traits, typename T, typename F>
-concept has_set_trait = requires(T &a, const F &f, int len) {
+concept has_set_trait = requires(T &a, const F &f, int64_t len) {
   { traits::set(a, f, len) };
 };
 } // namespace algo
\ No newline at end of file
@@ -5,16 +5,16 @@
 #include "proxy.hpp"
 
 namespace algo {
-template <typename T, typename f = std::plus<>, T base = monoid_identity<T, f>::x, typename F = T, typename traits = lazy_traits<T, F>>
+template <typename T, typename f = std::plus<>, typename Id = monoid_identity<T, f>, typename F = T, typename traits = lazy_traits<T, F, f>, typename Nodes = heap_nodes>
 class lazy_add_set_treap {
 private:
   using lazy_op = internal::lazy_add_set_op<F>;
   using combine = internal::lazy_add_set_combine<T, F, traits>;
   using reference = internal::proxy_ref<lazy_add_set_treap, T>;
 
-  internal::lazy_treap<T, f, base, lazy_op, combine> treap;
+  internal::lazy_treap<T, f, Id, lazy_op, combine, Nodes> treap;
 
-  lazy_add_set_treap(const internal::lazy_treap<T, f, base, lazy_op, combine> &r) : treap(r) {}
+  lazy_add_set_treap(internal::lazy_treap<T, f, Id, lazy_op, combine, Nodes> &&r) : treap(std::move(r)) {}
 
 public:
   lazy_add_set_treap() : treap() {}
@@ -36,6 +36,12 @@ public:
   /// @param a The elements to insert.
   void insert(std::size_t i, const std::vector<T> &a) { treap.insert(i, a); }
 
+  /// @brief Appends all the elements of `a` to the end of the treap in `O(|a| + log n)`.
+  /// @param a The elements to append, in order.
+  template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, T>
+  void append(R &&a) { treap.append(a); }
+
   /// @brief Erases the `i`-th element.
   /// @param i The index whose element needs to be erased.
   void erase(std::size_t i) { treap.erase(i); }
@@ -105,8 +111,8 @@ public:
   iterator end() { return iterator(this, size()); }
 };
 
-template <typename T, typename f = std::plus<>, T base = monoid_identity<T, f>::x, typename F = T, typename traits = lazy_traits<T, F>>
+template <typename T, typename f = std::plus<>, typename Id = monoid_identity<T, f>, typename F = T, typename traits = lazy_traits<T, F, f>, typename Nodes = heap_nodes>
 using lazy_treap = std::conditional_t<has_set_trait<traits, T, F>,
-                                      lazy_add_set_treap<T, f, base, F, traits>,
-                                      internal::lazy_treap<T, f, base, F, traits>>;
+                                      lazy_add_set_treap<T, f, Id, F, traits, Nodes>,
+                                      internal::lazy_treap<T, f, Id, F, traits, Nodes>>;
 }; // namespace algo
\ No newline at end of file
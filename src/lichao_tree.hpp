@@ -0,0 +1,98 @@
+#pragma once
+
+#include "sparse_lichao_tree.hpp"
+
+namespace algo {
+/// @brief An offline Li Chao tree, built over the x-coordinates that will be queried. The tree is
+/// a complete binary tree over the sorted x's, laid out as a heap in one preallocated array, so
+/// inserting never allocates.
+template <typename _T, typename Comp = std::less<typename internal::functor_traits<_T>::R>>
+class lichao_tree {
+private:
+  using int_t = typename internal::functor_traits<_T>::A;
+  using T = internal::lichao_entry<_T>;
+
+  std::vector<int_t> xs;
+  std::size_t n;
+  std::vector<T> tree;
+
+  // Padding leaves repeat the last x, which keeps the x's along the leaves sorted.
+  int_t x_at(std::size_t i) const { return xs[std::min(i, xs.size() - 1)]; }
+
+  bool comp(const T &a, const T &b, int_t x) const {
+    return a.active && (!b.active || Comp{}(a.f(x), b.f(x)));
+  }
+
+  // Inserts `f` into the subtree at heap index `i`, which covers the leaves [L, R].
+  void insert(std::size_t i, T f, std::size_t L, std::size_t R) {
+    while (true) {
+      std::size_t m = (L + R) / 2;
+      if (comp(f, tree[i], x_at(m))) {
+        std::swap(f, tree[i]);
+      }
+      if (L == R) {
+        return;
+      }
+      if (comp(f, tree[i], x_at(L))) {
+        i = 2 * i, R = m;
+      } else if (comp(f, tree[i], x_at(R))) {
+        i = 2 * i + 1, L = m + 1;
+      } else {
+        return;
+      }
+    }
+  }
+
+public:
+  /// @brief Builds the tree over `xs`; only these x's may be queried.
+  lichao_tree(std::vector<int_t> _xs) : xs(std::move(_xs)) {
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    if (xs.empty()) {
+      xs.push_back(int_t{});
+    }
+    n = std::bit_ceil(xs.size());
+    tree.resize(2 * n);
+  }
+
+  /// @brief Adds `x` over the query x's in [l, r].
+  void add(int_t l, int_t r, const _T &x) {
+    std::size_t a = std::lower_bound(xs.begin(), xs.end(), l) - xs.begin() + n;
+    std::size_t b = std::upper_bound(xs.begin(), xs.end(), r) - xs.begin() + n;
+    for (int h = 0; a < b; a >>= 1, b >>= 1, ++h) {
+      if (a & 1) {
+        std::size_t L = (a << h) - n;
+        insert(a++, T{x}, L, L + (std::size_t(1) << h) - 1);
+      }
+      if (b & 1) {
+        std::size_t L = (--b << h) - n;
+        insert(b, T{x}, L, L + (std::size_t(1) << h) - 1);
+      }
+    }
+  }
+  void add(const _T &x) { insert(1, T{x}, 0, n - 1); }
+
+  template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, _T>
+  void add(R &&fs) {
+    for (auto &&f : fs) {
+      insert(1, T{f}, 0, n - 1);
+    }
+  }
+
+  /// @brief The best function at `x`, which must be one of the x's the tree was built over.
+  std::optional<_T> query(int_t x) const {
+    std::size_t i = std::lower_bound(xs.begin(), xs.end(), x) - xs.begin() + n;
+    T ans;
+    for (; i > 0; i >>= 1) {
+      if (comp(tree[i], ans, x)) {
+        ans = tree[i];
+      }
+    }
+    if (ans.active) {
+      return ans.f;
+    }
+    return std::nullopt;
+  }
+};
+} // namespace algo
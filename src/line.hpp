@@ -11,5 +11,8 @@ public:
   line(const T &m, const T &b) : m(m), b(b) {}
 
   T operator()(const T &x) const { return m * x + b; }
+
+  const T &slope() const { return m; }
+  const T &intercept() const { return b; }
 };
-} // namespace algo
\ No newline at end of file
+} // namespace algo
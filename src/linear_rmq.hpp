@@ -0,0 +1,71 @@
+#pragma once
+
+#include "sparse_table.hpp"
+#include "traits.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace algo {
+/// @brief Range queries for selective idempotent monoids such as `min_t` and `max_t` in `O(1)`,
+/// with `O(n)` memory. The array is cut into blocks of 64; a `sparse_table` over the block results
+/// covers whole blocks, and within a block, a bitmask per index `r` marks the indices `j <= r`
+/// whose value wins over everything in (j, r], so the answer for [l, r] is the lowest bit `>= l`.
+/// @tparam T A monoid with `operator+` and `operator==`, where `a + b` is always `a` or `b`; see
+/// `is_selective`.
+template <typename T>
+  requires(is_idempotent_v<T> && is_selective_v<T>)
+class linear_rmq {
+private:
+  std::size_t n;
+  std::vector<T> vals;
+  std::vector<std::uint64_t> mask;
+  sparse_table<T> blocks;
+
+  // Whether `a` wins over `b`; ties go to `a`, the later index.
+  static bool wins(const T &a, const T &b) { return a + b == a; }
+
+  static std::vector<T> block_results(const std::vector<T> &vals) {
+    std::vector<T> res((vals.size() + 63) / 64);
+    for (std::size_t i = 0; i < vals.size(); ++i) {
+      res[i / 64] = i % 64 ? res[i / 64] + vals[i] : vals[i];
+    }
+    return res;
+  }
+
+  T in_block(std::size_t l, std::size_t r) const {
+    return vals[l + std::countr_zero(mask[r] >> (l % 64))];
+  }
+
+public:
+  template <typename M>
+  linear_rmq(const std::vector<M> &a) : n(a.size()), vals(a.begin(), a.end()), mask(n), blocks(block_results(vals)) {
+    for (std::size_t b = 0; b < n; b += 64) {
+      std::uint64_t m = 0;
+      for (std::size_t i = b; i < std::min(b + 64, n); ++i) {
+        // Pop the stack (the set bits of `m`, topmost first) while the new value wins.
+        while (m && wins(vals[i], vals[b + std::bit_width(m) - 1])) {
+          m ^= std::uint64_t(1) << (std::bit_width(m) - 1);
+        }
+        m |= std::uint64_t(1) << (i - b);
+        mask[i] = m;
+      }
+    }
+  }
+
+  T query(std::size_t l, std::size_t r) const {
+    std::size_t bl = l / 64, br = r / 64;
+    if (bl == br) {
+      return in_block(l, r);
+    }
+    T ans = in_block(l, bl * 64 + 63) + in_block(br * 64, r);
+    if (bl + 1 < br) {
+      ans = ans + blocks.query(bl + 1, br - 1);
+    }
+    return ans;
+  }
+
+  std::size_t size() const { return n; }
+};
+} // namespace algo
@@ -26,4 +26,6 @@ struct max_t {
 
 template <typename T>
 struct is_idempotent<max_t<T>> : std::true_type {};
+template <typename T>
+struct is_selective<max_t<T>> : std::true_type {};
 } // namespace algo
\ No newline at end of file
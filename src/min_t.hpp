@@ -26,4 +26,6 @@ struct min_t {
 
 template <typename T>
 struct is_idempotent<min_t<T>> : std::true_type {};
+template <typename T>
+struct is_selective<min_t<T>> : std::true_type {};
 } // namespace algo
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "line.hpp"
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace algo {
+namespace internal {
+#if defined(__SIZEOF_INT128__)
+template <typename T>
+using wide_t = std::conditional_t<std::is_integral_v<T>, __int128, T>;
+#else
+template <typename T>
+using wide_t = std::conditional_t<std::is_integral_v<T>, long double, T>;
+#endif
+} // namespace internal
+
+/// @brief The lower (or, with `std::greater<>`, upper) envelope of lines added in slope order,
+/// kept as a stack. Adding a line is amortised `O(1)`, and so is querying when the x's only grow.
+/// @tparam Comp `std::less<>` for minimum queries, which needs the slopes to be non-increasing, or
+/// `std::greater<>` for maximum queries, which needs them to be non-decreasing.
+template <typename T, typename Comp = std::less<>>
+class monotone_cht {
+private:
+  using wide = internal::wide_t<T>;
+
+  std::vector<line<T>> hull;
+  std::size_t head = 0;
+
+  // Whether `b` never beats both `a` and `c`, given slopes in insertion order `a`, `b`, `c`.
+  static bool useless(const line<T> &a, const line<T> &b, const line<T> &c) {
+    return wide(c.intercept() - a.intercept()) * (a.slope() - b.slope()) <=
+           wide(b.intercept() - a.intercept()) * (a.slope() - c.slope());
+  }
+
+public:
+  monotone_cht() = default;
+
+  /// @brief Adds `f`, whose slope must follow the order of the slopes added before it.
+  void add(const line<T> &f) {
+    if (!hull.empty() && hull.back().slope() == f.slope()) {
+      if (!Comp{}(f.intercept(), hull.back().intercept())) {
+        return;
+      }
+      hull.pop_back();
+    }
+    while (hull.size() >= head + 2 && useless(hull[hull.size() - 2], hull.back(), f)) {
+      hull.pop_back();
+    }
+    hull.push_back(f);
+    head = std::min(head, hull.size() - 1);
+  }
+
+  /// @brief The best value at `x`, if any line was added. Each `x` must be at least the previous
+  /// one queried; lines that can no longer win are dropped from the front.
+  std::optional<T> query(const T &x) {
+    if (hull.empty()) {
+      return std::nullopt;
+    }
+    while (head + 1 < hull.size() && !Comp{}(hull[head](x), hull[head + 1](x))) {
+      ++head;
+    }
+    return hull[head](x);
+  }
+
+  /// @brief The best value at an `x` in any order (but not below an `x` passed to `query`), by
+  /// binary search over the envelope, if any line was added.
+  std::optional<T> query_any(const T &x) const {
+    if (hull.empty()) {
+      return std::nullopt;
+    }
+    std::size_t lo = head, hi = hull.size() - 1;
+    while (lo < hi) {
+      std::size_t m = (lo + hi) / 2;
+      if (Comp{}(hull[m](x), hull[m + 1](x))) {
+        hi = m;
+      } else {
+        lo = m + 1;
+      }
+    }
+    return hull[lo](x);
+  }
+
+  bool empty() const { return hull.empty(); }
+  std::size_t size() const { return hull.size() - head; }
+};
+} // namespace algo
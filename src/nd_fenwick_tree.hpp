@@ -1,47 +1,94 @@
 #pragma once
 
 #include "fenwick_tree.hpp"
+#include <array>
+#include <tuple>
+#include <utility>
 
 namespace algo {
+/// @brief A `d`-dimensional Fenwick tree, stored as one flat row-major buffer. Only the strides are
+/// known at runtime; the loop over each dimension is unrolled at compile time.
 template <typename T, int d>
 class fenwick_tree {
 private:
-  std::size_t n;
-  std::vector<fenwick_tree<T, d - 1>> f;
+  std::array<std::size_t, d> n, stride;
+  std::vector<T> f;
 
-public:
-  template <typename... ints>
-  fenwick_tree(std::size_t n, ints... dims) : n(n), f(n + 1, fenwick_tree<T, d - 1>{dims...}) {}
+  template <int k>
+  void add_at(std::size_t off, const std::array<std::size_t, d> &idx, const T &x) {
+    for (std::size_t i = idx[k] + 1; i <= n[k]; i += i & -i) {
+      if constexpr (k + 1 == d) {
+        f[off + i] = f[off + i] + x;
+      } else {
+        add_at<k + 1>(off + i * stride[k], idx, x);
+      }
+    }
+  }
+
+  // `a` holds a range `(l, r)` for each of the first `m - d` dimensions, then a prefix end for
+  // each of the remaining ones.
+  template <int k, std::size_t m>
+  T sum_at(std::size_t off, const std::array<std::size_t, m> &a) const {
+    auto at = [&](std::size_t i) {
+      if constexpr (k + 1 == d) {
+        return f[off + i];
+      } else {
+        return sum_at<k + 1>(off + i * stride[k], a);
+      }
+    };
+    T ans = T{};
+    if constexpr (k < int(m - d)) {
+      for (std::size_t r = a[2 * k + 1] + 1; r > 0; r -= r & -r) {
+        ans = ans + at(r);
+      }
+      for (std::size_t l = a[2 * k]; l > 0; l -= l & -l) {
+        ans = ans - at(l);
+      }
+    } else {
+      for (std::size_t i = a[m - d + k] + 1; i > 0; i -= i & -i) {
+        ans = ans + at(i);
+      }
+    }
+    return ans;
+  }
 
+public:
   template <typename... ints>
-  void apply(std::size_t i, ints... next) {
-    for (++i; i <= n; i += i & -i) {
-      f[i].apply(next...);
+    requires(sizeof...(ints) == d - 1)
+  fenwick_tree(std::size_t n0, ints... dims) : n{n0, std::size_t(dims)...} {
+    std::size_t total = 1;
+    for (int k = d - 1; k >= 0; --k) {
+      stride[k] = total;
+      total *= n[k] + 1;
     }
+    f.assign(total, T{});
+  }
+
+  /// @brief Adds `x` at a point: `apply(i_0, ..., i_{d-1}, x)`.
+  template <typename... Args>
+    requires(sizeof...(Args) == d)
+  void apply(std::size_t i, Args... next) {
+    auto args = std::make_tuple(next...);
+    [&]<std::size_t... k>(std::index_sequence<k...>) {
+      add_at<0>(0, {i, std::size_t(std::get<k>(args))...}, T(std::get<d - 1>(args)));
+    }(std::make_index_sequence<d - 1>{});
   }
 
+  /// @brief Accumulates the box [0, i_0] x ... x [0, i_{d-1}].
   template <typename... ints>
     requires(sizeof...(ints) == d - 1)
   T query(std::size_t i, ints... dims) const {
-    T ans = T{};
-    for (++i; i > 0; i -= i & -i) {
-      ans = ans + f[i].query(dims...);
-    }
-    return ans;
+    return sum_at<0>(0, std::array<std::size_t, d>{i, std::size_t(dims)...});
   }
 
+  /// @brief Accumulates over [l, r] in the first dimension; each following dimension takes
+  /// either a range `l, r` or, once the ranges stop, a prefix end `i`.
   template <typename... ints>
+    requires(sizeof...(ints) >= d - 1 && sizeof...(ints) <= 2 * d - 2)
   T query(std::size_t l, std::size_t r, ints... dims) const
     requires requires(T a, T b) { a - b; }
   {
-    T ans = T{};
-    for (++r; r > 0; r -= r & -r) {
-      ans = ans + f[r].query(dims...);
-    }
-    for (; l > 0; l -= l & -l) {
-      ans = ans - f[l].query(dims...);
-    }
-    return ans;
+    return sum_at<0>(0, std::array<std::size_t, 2 + sizeof...(ints)>{l, r, std::size_t(dims)...});
   }
 };
-}; // namespace algo
\ No newline at end of file
+}; // namespace algo
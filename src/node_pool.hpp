@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace algo {
+// A node policy provides, for a node type, a handle type `ptr` with a `null` value, static
+// `get(ptr)`, `make(args...)` and `free(ptr)`, and a `lifetime` type that every container holds
+// as a member. Pools are shared by every container of the same node type (nodes move between them
+// on split/merge), and are not thread-safe. Destroying a container still visits each of its nodes
+// to return it to the pool, in `O(n)`; the pool's own memory is handed back by `release()`, or at
+// program exit once every container has been destroyed.
+
+/// @brief Allocates every node separately with `new` and frees it with `delete`.
+struct heap_nodes {
+  template <typename node>
+  struct pool {
+    using ptr = node *;
+    static constexpr ptr null = nullptr;
+
+    struct lifetime {};
+
+    static node &get(ptr p) { return *p; }
+
+    template <typename... Args>
+    static ptr make(Args &&...args) { return new node(std::forward<Args>(args)...); }
+
+    static void free(ptr p) { delete p; }
+  };
+};
+
+/// @brief Carves nodes out of slabs of `slab` nodes and recycles freed nodes through a free list,
+/// so nodes sit next to each other in memory and the system allocator is only hit once per slab.
+template <std::size_t slab = 1 << 16>
+struct pooled_nodes {
+  template <typename node>
+  struct pool {
+    using ptr = node *;
+    static constexpr ptr null = nullptr;
+
+    struct arena {
+      std::vector<node *> slabs, free_list;
+      std::size_t used = slab;
+
+      void clear() {
+        for (node *s : slabs) {
+          std::allocator<node>{}.deallocate(s, slab);
+        }
+        slabs.clear(), free_list.clear();
+        used = slab;
+      }
+
+      ~arena() { clear(); }
+    };
+
+    // Built on first use, and by every container before it takes any node, so it is destroyed
+    // after all of them, even those with static storage duration.
+    static arena &mem() {
+      static arena a;
+      return a;
+    }
+
+    struct lifetime {
+      lifetime() { mem(); }
+    };
+
+    static node &get(ptr p) { return *p; }
+
+    template <typename... Args>
+    static ptr make(Args &&...args) {
+      arena &m = mem();
+      node *p;
+      if (!m.free_list.empty()) {
+        p = m.free_list.back();
+        m.free_list.pop_back();
+      } else {
+        if (m.used == slab) {
+          m.slabs.push_back(std::allocator<node>{}.allocate(slab));
+          m.used = 0;
+        }
+        p = m.slabs.back() + m.used++;
+      }
+      return std::construct_at(p, std::forward<Args>(args)...);
+    }
+
+    static void free(ptr p) {
+      std::destroy_at(p);
+      mem().free_list.push_back(p);
+    }
+
+    /// @brief Hands every slab back to the system. Every container using this pool must already
+    /// be destroyed or empty.
+    static void release() { mem().clear(); }
+  };
+};
+
+/// @brief Stores all nodes in one vector and links them by 32-bit indices instead of pointers,
+/// which shrinks every node by 8 bytes. Handle `0` is null; handle `i` is `nodes[i - 1]`. Nodes
+/// must be default-constructible, which freed slots are reset to.
+struct indexed_nodes {
+  template <typename node>
+  struct pool {
+    using ptr = std::uint32_t;
+    static constexpr ptr null = 0;
+
+    struct arena {
+      std::vector<node> nodes;
+      std::vector<ptr> free_list;
+    };
+
+    // Built on first use, and by every container before it takes any node, so it is destroyed
+    // after all of them, even those with static storage duration.
+    static arena &mem() {
+      static arena a;
+      return a;
+    }
+
+    // `mem().nodes.data()`, kept here so that `get` does not pay for the guard of `mem()`.
+    static inline node *data = nullptr;
+
+    struct lifetime {
+      lifetime() { mem(); }
+    };
+
+    static node &get(ptr p) { return data[p - 1]; }
+
+    template <typename... Args>
+    static ptr make(Args &&...args) {
+      arena &m = mem();
+      if (!m.free_list.empty()) {
+        ptr p = m.free_list.back();
+        m.free_list.pop_back();
+        m.nodes[p - 1] = node(std::forward<Args>(args)...);
+        return p;
+      }
+      m.nodes.emplace_back(std::forward<Args>(args)...);
+      data = m.nodes.data();
+      return m.nodes.size();
+    }
+
+    // The slot stays in the vector, so it is reset to let go of whatever the node owned.
+    static void free(ptr p) {
+      get(p) = node();
+      mem().free_list.push_back(p);
+    }
+
+    /// @brief Hands all node memory back to the system. Every container using this pool must
+    /// already be destroyed or empty.
+    static void release() {
+      arena &m = mem();
+      std::vector<node>().swap(m.nodes);
+      std::vector<ptr>().swap(m.free_list);
+      data = nullptr;
+    }
+  };
+};
+} // namespace algo
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "dsu_with_rollbacks.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace algo {
+/// @brief Answers connectivity queries on a graph whose edges are added and removed over time,
+/// once all events are known. Every edge lives for an interval of queries, which is cut into the
+/// `O(log q)` nodes of a segment tree over the queries; a depth-first walk of that tree merges
+/// each node's edges into a `dsu_with_rollbacks` on the way down and undoes them on the way up,
+/// for `O(q log q log n)` in total.
+class offline_dynamic_connectivity {
+private:
+  struct event {
+    int u, v;
+    bool add;
+    std::size_t time;
+  };
+
+  int n;
+  std::vector<event> events;
+  // Each query's vertices, with `u == -1` for a component count.
+  std::vector<std::pair<int, int>> queries;
+
+  std::uint64_t key(const event &e) const {
+    return std::uint64_t(std::min(e.u, e.v)) * n + std::max(e.u, e.v);
+  }
+
+public:
+  offline_dynamic_connectivity(int n) : n(n) {}
+
+  /// @brief Adds the edge `(u, v)`; the same edge may be added several times.
+  void add_edge(int u, int v) { events.push_back({u, v, true, queries.size()}); }
+
+  /// @brief Removes one copy of the edge `(u, v)`, if present.
+  void remove_edge(int u, int v) { events.push_back({u, v, false, queries.size()}); }
+
+  /// @brief Asks whether `u` and `v` are connected at this point.
+  /// @return The index of the answer in `solve()`.
+  std::size_t connected(int u, int v) {
+    queries.push_back({u, v});
+    return queries.size() - 1;
+  }
+
+  /// @brief Asks for the number of components at this point.
+  /// @return The index of the answer in `solve()`.
+  std::size_t components() {
+    queries.push_back({-1, -1});
+    return queries.size() - 1;
+  }
+
+  /// @brief Answers every query: `1` or `0` for `connected`, the count for `components`.
+  std::vector<int> solve() const {
+    std::size_t q = queries.size(), m = std::bit_ceil(std::max<std::size_t>(q, 1));
+    // An edge added before query `l` and removed before query `r` is present for queries [l, r).
+    std::vector<std::pair<std::size_t, std::size_t>> spans;
+    std::vector<std::pair<int, int>> ends;
+    std::vector<std::size_t> order(events.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return key(events[a]) < key(events[b]); });
+    std::vector<std::size_t> open;
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      const event &e = events[order[i]];
+      if (e.add) {
+        open.push_back(e.time);
+      } else if (!open.empty()) {
+        spans.push_back({open.back(), e.time});
+        ends.push_back({e.u, e.v});
+        open.pop_back();
+      }
+      if (i + 1 == order.size() || key(events[order[i + 1]]) != key(e)) {
+        for (std::size_t l : open) {
+          spans.push_back({l, q});
+          ends.push_back({e.u, e.v});
+        }
+        open.clear();
+      }
+    }
+
+    // Bucket the edges by segment tree node, in one flat array.
+    std::vector<std::size_t> start(2 * m + 1);
+    auto cover = [&](std::size_t l, std::size_t r, auto &&fn) {
+      for (l += m, r += m; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+          fn(l++);
+        }
+        if (r & 1) {
+          fn(--r);
+        }
+      }
+    };
+    for (auto [l, r] : spans) {
+      cover(l, r, [&](std::size_t i) { ++start[i + 1]; });
+    }
+    for (std::size_t i = 1; i <= 2 * m; ++i) {
+      start[i] += start[i - 1];
+    }
+    std::vector<std::pair<int, int>> edges(start[2 * m]);
+    std::vector<std::size_t> pos(start.begin(), start.end() - 1);
+    for (std::size_t j = 0; j < spans.size(); ++j) {
+      cover(spans[j].first, spans[j].second, [&](std::size_t i) { edges[pos[i]++] = ends[j]; });
+    }
+
+    // Walk the tree with an explicit stack; an entry `2 * i + 1` means "leave node `i`".
+    std::vector<int> ans(q);
+    dsu_with_rollbacks<int> d(n);
+    std::vector<int> merged(2 * m);
+    int comps = n;
+    std::vector<std::size_t> stack{2};
+    while (!stack.empty()) {
+      std::size_t i = stack.back() / 2;
+      bool leave = stack.back() & 1;
+      stack.pop_back();
+      if (leave) {
+        for (int k = 0; k < merged[i]; ++k) {
+          d.undo();
+        }
+        comps += merged[i];
+        continue;
+      }
+      // Skip subtrees that only cover padding leaves.
+      if ((i << (std::bit_width(m) - std::bit_width(i))) - m >= q) {
+        continue;
+      }
+      merged[i] = 0;
+      for (std::size_t k = start[i]; k < start[i + 1]; ++k) {
+        merged[i] += d.merge(edges[k].first, edges[k].second);
+      }
+      comps -= merged[i];
+      stack.push_back(2 * i + 1);
+      if (i >= m) {
+        auto [u, v] = queries[i - m];
+        ans[i - m] = u == -1 ? comps : d.root(u) == d.root(v);
+      } else {
+        stack.push_back(2 * (2 * i + 1));
+        stack.push_back(2 * (2 * i));
+      }
+    }
+    return ans;
+  }
+};
+} // namespace algo
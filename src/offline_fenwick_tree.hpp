@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace algo {
+/// @brief A 2D Fenwick tree over a sparse set of points known up front, for coordinates too large
+/// for `fenwick_tree<T, 2>`. x is compressed over all points, and each x-node only keeps a Fenwick
+/// tree over the sorted y's of the points below it, so `O(n log n)` cells are stored in total, in
+/// one contiguous array with per-node offsets.
+/// @tparam T Any associative and commutative type with an identity element and a defined `operator+`.
+/// @tparam C The coordinate type.
+template <typename T, typename C = int64_t>
+class offline_fenwick_tree {
+private:
+  std::vector<C> xs, ys;
+  // x-node `i` (1-indexed) owns `ys` and `f` over [start[i], start[i + 1]).
+  std::vector<std::size_t> start;
+  std::vector<T> f;
+
+  std::size_t x_upper(const C &x) const { return std::upper_bound(xs.begin(), xs.end(), x) - xs.begin(); }
+  std::size_t x_lower(const C &x) const { return std::lower_bound(xs.begin(), xs.end(), x) - xs.begin(); }
+
+  // Sum of the first `j` cells of x-node `i`.
+  T row(std::size_t i, std::size_t j) const {
+    T ans = T{};
+    for (; j > 0; j &= j - 1) {
+      ans = ans + f[start[i] + j - 1];
+    }
+    return ans;
+  }
+
+  // Sum over the points among the first `i` x's whose y is at most `y`.
+  T prefix(std::size_t i, const C &y) const {
+    T ans = T{};
+    for (; i > 0; i &= i - 1) {
+      auto first = ys.begin() + start[i], last = ys.begin() + start[i + 1];
+      ans = ans + row(i, std::upper_bound(first, last, y) - first);
+    }
+    return ans;
+  }
+
+  // Sum over the points among the first `i` x's whose y lies in [yl, yr].
+  T prefix(std::size_t i, const C &yl, const C &yr) const {
+    T ans = T{};
+    for (; i > 0; i &= i - 1) {
+      auto first = ys.begin() + start[i], last = ys.begin() + start[i + 1];
+      auto lo = std::lower_bound(first, last, yl);
+      ans = ans + row(i, std::upper_bound(lo, last, yr) - first) - row(i, lo - first);
+    }
+    return ans;
+  }
+
+public:
+  /// @brief Prepares the tree for updates at `points`; `apply` may only be called at these points.
+  template <typename M>
+  offline_fenwick_tree(const std::vector<std::pair<M, M>> &pts) {
+    std::vector<std::pair<C, C>> points(pts.begin(), pts.end());
+    for (const auto &[x, y] : points) {
+      xs.push_back(x);
+    }
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    std::size_t n = xs.size();
+    // Visiting the points in y order hands every node its y's already sorted, so a node only has
+    // to skip a y equal to the last one it took.
+    std::sort(points.begin(), points.end(), [](const auto &a, const auto &b) { return a.second < b.second; });
+    std::vector<std::size_t> cap(n + 2), size(n + 1);
+    for (const auto &[x, y] : points) {
+      for (std::size_t i = x_upper(x); i <= n; i += i & -i) {
+        ++cap[i + 1];
+      }
+    }
+    for (std::size_t i = 1; i <= n + 1; ++i) {
+      cap[i] += cap[i - 1];
+    }
+    std::vector<C> all(cap[n + 1]);
+    for (const auto &[x, y] : points) {
+      for (std::size_t i = x_upper(x); i <= n; i += i & -i) {
+        if (size[i] == 0 || all[cap[i] + size[i] - 1] != y) {
+          all[cap[i] + size[i]++] = y;
+        }
+      }
+    }
+    start.assign(n + 2, 0);
+    for (std::size_t i = 1; i <= n; ++i) {
+      start[i + 1] = start[i] + size[i];
+    }
+    ys.resize(start[n + 1]);
+    for (std::size_t i = 1; i <= n; ++i) {
+      std::copy_n(all.begin() + cap[i], size[i], ys.begin() + start[i]);
+    }
+    f.assign(ys.size(), T{});
+  }
+
+  /// @brief Adds `v` at point `(x, y)`, which must be one of the points given on construction.
+  void apply(const C &x, const C &y, const T &v) {
+    for (std::size_t i = x_upper(x); i <= xs.size(); i += i & -i) {
+      std::size_t len = start[i + 1] - start[i];
+      auto first = ys.begin() + start[i];
+      for (std::size_t j = std::upper_bound(first, first + len, y) - first; j <= len; j += j & -j) {
+        f[start[i] + j - 1] = f[start[i] + j - 1] + v;
+      }
+    }
+  }
+
+  /// @brief Accumulates over all points with coordinates at most `(x, y)`.
+  T query(const C &x, const C &y) const { return prefix(x_upper(x), y); }
+
+  /// @brief Accumulates over all points in [xl, xr] with y at most `y`.
+  T query(const C &xl, const C &xr, const C &y) const
+    requires requires(T a, T b) { a - b; }
+  {
+    return prefix(x_upper(xr), y) - prefix(x_lower(xl), y);
+  }
+
+  /// @brief Accumulates over all points in the rectangle [xl, xr] x [yl, yr].
+  T query(const C &xl, const C &xr, const C &yl, const C &yr) const
+    requires requires(T a, T b) { a - b; }
+  {
+    return prefix(x_upper(xr), yl, yr) - prefix(x_lower(xl), yl, yr);
+  }
+};
+} // namespace algo
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "monoid.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace algo {
+/// @brief A persistent segment tree. Every `set` copies the `O(log n)` nodes on one root-to-leaf
+/// path into a new version and shares everything else, so all earlier versions stay queryable.
+/// Nodes are bump-allocated from one contiguous arena and linked by 32-bit indices; node `0` is
+/// the shared all-identity subtree.
+template <typename T, typename f = std::plus<>, typename Id = monoid_identity<T, f>>
+class persistent_segment_tree {
+private:
+  struct node {
+    T x;
+    std::uint32_t l, r;
+  };
+
+  std::size_t _n, n;
+  int h;
+  std::vector<node> arena;
+  std::vector<std::uint32_t> roots;
+
+  T op(const T &a, const T &b) const {
+    if constexpr (std::is_same_v<std::invoke_result_t<f &, T, T>, bool>) {
+      return f{}(a, b) ? a : b;
+    } else {
+      return f{}(a, b);
+    }
+  }
+
+  T base() const { return Id{}(); }
+
+  std::uint32_t make(const T &x, std::uint32_t l, std::uint32_t r) {
+    arena.push_back({x, l, r});
+    return arena.size() - 1;
+  }
+
+  std::uint32_t build(const std::vector<T> &vals, std::size_t lo, std::size_t len) {
+    if (lo >= vals.size()) {
+      return 0;
+    }
+    if (len == 1) {
+      return make(vals[lo], 0, 0);
+    }
+    std::uint32_t l = build(vals, lo, len / 2), r = build(vals, lo + len / 2, len / 2);
+    return make(op(arena[l].x, arena[r].x), l, r);
+  }
+
+  T query(std::uint32_t t, std::size_t lo, std::size_t len, std::size_t l, std::size_t r) const {
+    if (t == 0 || r < lo || lo + len <= l) {
+      return base();
+    }
+    if (l <= lo && lo + len - 1 <= r) {
+      return arena[t].x;
+    }
+    return op(query(arena[t].l, lo, len / 2, l, r), query(arena[t].r, lo + len / 2, len / 2, l, r));
+  }
+
+  template <bool diff>
+  T value(std::uint32_t a, std::uint32_t b) const {
+    if constexpr (diff) {
+      return arena[b].x - arena[a].x;
+    } else {
+      return arena[b].x;
+    }
+  }
+
+  // Walks versions `a` and `b` side by side; with `diff`, a node's value is `b`'s minus `a`'s.
+  template <bool diff, typename Fn>
+  std::size_t min_right(std::uint32_t a, std::uint32_t b, std::size_t lo, std::size_t len, std::size_t l, Fn &t, T &p) const {
+    if (lo + len <= l) {
+      return lo + len;
+    }
+    if (l <= lo) {
+      T q = op(p, value<diff>(a, b));
+      if (t(q)) {
+        p = q;
+        return lo + len;
+      }
+      if (len == 1) {
+        return lo;
+      }
+    }
+    std::size_t i = min_right<diff>(arena[a].l, arena[b].l, lo, len / 2, l, t, p);
+    if (i < lo + len / 2) {
+      return i;
+    }
+    return min_right<diff>(arena[a].r, arena[b].r, lo + len / 2, len / 2, l, t, p);
+  }
+
+public:
+  /// @brief Creates version `0`, with all `_n` values equal to the identity.
+  persistent_segment_tree(std::size_t _n) : _n(_n), n(std::bit_ceil(_n)), h(std::countr_zero(n)), arena{{base(), 0, 0}}, roots{0} {}
+
+  /// @brief Creates version `0` from `vals`.
+  persistent_segment_tree(const std::vector<T> &vals) : persistent_segment_tree(vals.size()) {
+    arena.reserve(2 * n);
+    roots[0] = build(vals, 0, n);
+  }
+
+  /// @brief Reserves arena space for `nodes` more nodes; each `set` uses `log2(n) + 1`.
+  void reserve(std::size_t nodes) { arena.reserve(arena.size() + nodes); }
+
+  /// @brief Creates a new version equal to `version` except that index `i` holds `x`.
+  /// @param version The version to start from; it is left unchanged.
+  /// @param i The index at which the value is being modified.
+  /// @param x The new value at that index.
+  /// @return The id of the new version.
+  std::size_t set(std::size_t version, std::size_t i, const T &x) {
+    std::array<std::uint32_t, 64> path;
+    std::uint32_t t = roots[version];
+    for (int d = 0; d < h; ++d) {
+      path[d] = t;
+      t = (i >> (h - 1 - d) & 1) ? arena[t].r : arena[t].l;
+    }
+    t = make(x, 0, 0);
+    for (int d = h - 1; d >= 0; --d) {
+      auto [_, l, r] = arena[path[d]];
+      if (i >> (h - 1 - d) & 1) {
+        t = make(op(arena[l].x, arena[t].x), l, t);
+      } else {
+        t = make(op(arena[t].x, arena[r].x), t, r);
+      }
+    }
+    roots.push_back(t);
+    return roots.size() - 1;
+  }
+
+  /// @brief Performs associative accumulation in a given version.
+  /// @param version The version to query.
+  /// @param l The left endpoint (inclusive) of the range to accumulate.
+  /// @param r The right endpoint (inclusive) of the range to accumulate.
+  /// @return Returns the accumulated result of [l, r] in `version`.
+  T query(std::size_t version, std::size_t l, std::size_t r) const { return query(roots[version], 0, n, l, r); }
+
+  /// @brief Returns the value at index `i` in a given version.
+  const T &at(std::size_t version, std::size_t i) const {
+    std::uint32_t t = roots[version];
+    for (int d = 0; d < h; ++d) {
+      t = (i >> (h - 1 - d) & 1) ? arena[t].r : arena[t].l;
+    }
+    return arena[t].x;
+  }
+
+  /// @brief Finds the smallest index r ≥ l such that the predicate returns false for the
+  /// accumulated value over [l, r] in `version`.
+  /// @return The first such index, or `size()` if `t` holds for all r ∈ [l, n).
+  template <typename Fn>
+  std::size_t min_right(std::size_t version, std::size_t l, Fn &&t) const {
+    T p = base();
+    return std::min(_n, min_right<false>(0, roots[version], 0, n, l, t, p));
+  }
+
+  /// @brief Like `min_right`, but over the difference between two versions: the value of a range
+  /// is its accumulation in `v` minus its accumulation in `u`. Only present when `T` has `operator-`.
+  template <typename Fn>
+  std::size_t min_right(std::size_t u, std::size_t v, std::size_t l, Fn &&t) const
+    requires requires(T a, T b) { a - b; }
+  {
+    T p = base();
+    return std::min(_n, min_right<true>(roots[u], roots[v], 0, n, l, t, p));
+  }
+
+  /// @brief Order statistics on the difference between two versions: with counts as values,
+  /// returns the smallest index i such that the total over [0, i] in `v` minus `u` exceeds `k`.
+  /// @return The index, or `size()` if the total never exceeds `k`.
+  std::size_t kth(std::size_t u, std::size_t v, const T &k) const
+    requires requires(T a, T b) { a - b; a < b; }
+  {
+    return min_right(u, v, 0, [&](const T &s) { return !(k < s); });
+  }
+
+  /// @brief Returns the number of versions created so far.
+  std::size_t versions() const { return roots.size(); }
+
+  std::size_t size() const { return _n; }
+};
+} // namespace algo
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace algo {
+/// @brief A sparse segment tree whose nodes live in one arena and link to their children by 32-bit
+/// indices. A node's bounds are implied by the path to it, so it only stores its value and two
+/// child indices; index `0` is the shared empty subtree.
+/// @tparam T Monoid type (must define `operator+` and provide an identity element `T{}`).
+template <typename T>
+class pooled_sparse_segment_tree {
+private:
+  struct node {
+    T val;
+    std::uint32_t l, r;
+  };
+
+  int64_t s, e;
+  std::vector<node> nodes;
+
+  std::uint32_t make() {
+    nodes.push_back({T{}, 0, 0});
+    return nodes.size() - 1;
+  }
+
+  T query(std::uint32_t t, int64_t lo, int64_t hi, int64_t l, int64_t r) const {
+    if (t == 0 || r < lo || hi < l) {
+      return T{};
+    }
+    if (l <= lo && hi <= r) {
+      return nodes[t].val;
+    }
+    int64_t m = std::midpoint(lo, hi);
+    return query(nodes[t].l, lo, m, l, r) + query(nodes[t].r, m + 1, hi, l, r);
+  }
+
+  template <typename Fn>
+  int64_t min_right(std::uint32_t t, int64_t lo, int64_t hi, int64_t l, Fn &pred, T &p) const {
+    if (t == 0 || hi < l) {
+      return hi + 1;
+    }
+    if (l <= lo) {
+      T q = p + nodes[t].val;
+      if (pred(q)) {
+        p = q;
+        return hi + 1;
+      }
+      if (lo == hi) {
+        return lo;
+      }
+    }
+    int64_t m = std::midpoint(lo, hi);
+    int64_t i = min_right(nodes[t].l, lo, m, l, pred, p);
+    return i <= m ? i : min_right(nodes[t].r, m + 1, hi, l, pred, p);
+  }
+
+public:
+  pooled_sparse_segment_tree(int64_t l, int64_t r) : s(l), e(r), nodes{{T{}, 0, 0}, {T{}, 0, 0}} {}
+  pooled_sparse_segment_tree(std::size_t n) : pooled_sparse_segment_tree(0, int64_t(n) - 1) {}
+
+  /// @brief Reserves arena space for `n` more nodes; each `set` creates at most `log2(size())` + 1.
+  void reserve(std::size_t n) { nodes.reserve(nodes.size() + n); }
+
+  /// @brief Sets the value at the `i`-th index to `x`.
+  /// @param i The index at which the value is being modified.
+  /// @param x The new value at that index.
+  /// @return The accumulated value over the whole range.
+  T set(int64_t i, const T &x) {
+    std::array<std::uint32_t, 64> path;
+    int d = 0;
+    std::uint32_t t = 1;
+    for (int64_t lo = s, hi = e; lo < hi; ++d) {
+      path[d] = t;
+      int64_t m = std::midpoint(lo, hi);
+      if (i <= m) {
+        if (!nodes[t].l) {
+          std::uint32_t c = make();
+          nodes[t].l = c;
+        }
+        t = nodes[t].l, hi = m;
+      } else {
+        if (!nodes[t].r) {
+          std::uint32_t c = make();
+          nodes[t].r = c;
+        }
+        t = nodes[t].r, lo = m + 1;
+      }
+    }
+    nodes[t].val = x;
+    while (d-- > 0) {
+      node &n = nodes[path[d]];
+      n.val = nodes[n.l].val + nodes[n.r].val;
+    }
+    return nodes[1].val;
+  }
+
+  /// @brief Finds the smallest index i ≥ l such that the predicate returns
+  /// false for the accumulated value over [l, i].
+  /// @return The first such index, or `e + 1` if the predicate holds up to the end.
+  template <typename Fn>
+  int64_t min_right(int64_t l, Fn &&pred) const {
+    T p = T{};
+    return min_right(1, s, e, l, pred, p);
+  }
+
+  /// @brief Performs associative accumulation.
+  /// @param l The left endpoint (inclusive) of the range to accumulate.
+  /// @param r The right endpoint (inclusive) of the range to accumulate.
+  /// @return Returns the accumulated result of [l, r].
+  T query(int64_t l, int64_t r) const { return query(1, s, e, l, r); }
+
+  /// @brief Returns the value at index `i`.
+  T at(int64_t i) const {
+    std::uint32_t t = 1;
+    for (int64_t lo = s, hi = e; t && lo < hi;) {
+      int64_t m = std::midpoint(lo, hi);
+      if (i <= m) {
+        t = nodes[t].l, hi = m;
+      } else {
+        t = nodes[t].r, lo = m + 1;
+      }
+    }
+    return nodes[t].val;
+  }
+
+  std::size_t size() const { return e - s + 1; }
+
+  /// @brief The number of nodes allocated so far.
+  std::size_t node_count() const { return nodes.size() - 1; }
+};
+} // namespace algo
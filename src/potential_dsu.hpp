@@ -0,0 +1,117 @@
+#pragma once
+
+#include "xor_t.hpp"
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace algo {
+/// @brief A disjoint set union that also keeps, for every element, its potential relative to the
+/// root of its component, so relations like `x_v - x_u = w` can be added and queried.
+/// @tparam T Element type.
+/// @tparam G An abelian group with `operator+`, `operator-` and identity `G{}`, such as `int64_t`,
+/// `mint` or `xor_t`.
+/// @tparam Serializer An optional serializer mapping `T` bijectively to `int`.
+template <typename T, typename G = int64_t, typename Serializer = void>
+class potential_dsu {
+private:
+  std::vector<int> par, m_size;
+  // `x_u = x_{par[u]} + pot[u]`.
+  std::vector<G> pot;
+  std::vector<int> path;
+
+  using serializer_t = std::conditional_t<std::is_void_v<Serializer>, std::monostate, Serializer>;
+  [[no_unique_address]] serializer_t serializer;
+
+  int id(const T &u) const {
+    if constexpr (std::is_void_v<Serializer>) {
+      return u;
+    } else {
+      return serializer(u);
+    }
+  }
+
+  // Finds `u`'s root, then points every node on the way straight at it, adding up the potentials
+  // from the top down.
+  int _root(int u) {
+    while (par[u] != u) {
+      path.push_back(u);
+      u = par[u];
+    }
+    while (path.size() > 1) {
+      int v = path.back();
+      path.pop_back();
+      int w = path.back();
+      pot[w] = pot[w] + pot[v];
+      par[w] = u;
+    }
+    path.clear();
+    return u;
+  }
+
+public:
+  potential_dsu(int n, serializer_t s = {}) : par(n), m_size(n, 1), pot(n), serializer(std::move(s)) {
+    std::iota(par.begin(), par.end(), 0);
+  }
+
+  /// @brief Returns the root of the component `u` is part of.
+  T root(const T &u) {
+    if constexpr (std::is_void_v<Serializer>) {
+      return _root(u);
+    } else {
+      return serializer(_root(serializer(u)));
+    }
+  }
+
+  /// @brief Returns `x_u - x_r`, where `r` is the root of `u`'s component.
+  G potential(const T &u) {
+    int _u = id(u);
+    _root(_u);
+    return pot[_u];
+  }
+
+  /// @brief Records `x_v - x_u = w`, merging the components of `u` and `v`.
+  /// @return Returns `false` if `u` and `v` were already part of the same component and the
+  /// relation contradicts what is known, in which case it is ignored, and `true` otherwise.
+  bool merge(const T &u, const T &v, const G &w) {
+    int _u = id(u), _v = id(v);
+    int ru = _root(_u), rv = _root(_v);
+    if (ru == rv) {
+      return pot[_v] - pot[_u] == w;
+    }
+    // `x_rv - x_ru`.
+    G d = w + pot[_u] - pot[_v];
+    if (m_size[ru] < m_size[rv]) {
+      par[ru] = rv;
+      pot[ru] = G{} - d;
+      m_size[rv] += m_size[ru];
+    } else {
+      par[rv] = ru;
+      pot[rv] = d;
+      m_size[ru] += m_size[rv];
+    }
+    return true;
+  }
+
+  /// @brief Returns `x_v - x_u` if `u` and `v` are part of the same component.
+  std::optional<G> diff(const T &u, const T &v) {
+    int _u = id(u), _v = id(v);
+    if (_root(_u) != _root(_v)) {
+      return std::nullopt;
+    }
+    return pot[_v] - pot[_u];
+  }
+
+  bool same(const T &u, const T &v) { return _root(id(u)) == _root(id(v)); }
+
+  int size(const T &u) { return m_size[_root(id(u))]; }
+};
+
+/// @brief A `potential_dsu` over parities: `merge(u, v, true)` records that `u` and `v` differ,
+/// as in bipartiteness checks.
+template <typename T, typename Serializer = void>
+using parity_dsu = potential_dsu<T, xor_t<bool>, Serializer>;
+} // namespace algo
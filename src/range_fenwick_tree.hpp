@@ -0,0 +1,53 @@
+#pragma once
+
+#include "fenwick_tree.hpp"
+#include <vector>
+
+namespace algo {
+/// @brief A Fenwick tree supporting range additions and range sums. It keeps two trees over the
+/// differences `d[k] = a[k] - a[k - 1]`: one of `d[k]` and one of `d[k] * k`, since the prefix sum
+/// of `a` up to `i` is `(i + 1) * Σ d[k] - Σ d[k] * k`.
+/// @tparam T An abelian group under `operator+` and `operator-` that can be multiplied by an index.
+template <typename T>
+class range_fenwick_tree {
+private:
+  std::size_t n;
+  fenwick_tree<T, 1> d, dk;
+
+  static std::vector<T> differences(const std::vector<T> &a, bool scaled) {
+    std::vector<T> res(a.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      res[i] = i == 0 ? a[0] : a[i] - a[i - 1];
+      if (scaled) {
+        res[i] = res[i] * T(i);
+      }
+    }
+    return res;
+  }
+
+  range_fenwick_tree(const std::vector<T> &a, int) : n(a.size()), d(differences(a, false)), dk(differences(a, true)) {}
+
+public:
+  range_fenwick_tree(std::size_t n) : n(n), d(n), dk(n) {}
+
+  /// @brief Builds the tree over `vals` in `O(n)`.
+  template <typename M>
+  range_fenwick_tree(const std::vector<M> &vals) : range_fenwick_tree(std::vector<T>(vals.begin(), vals.end()), 0) {}
+
+  /// @brief Adds `x` to every element in [l, r].
+  void apply(std::size_t l, std::size_t r, const T &x) {
+    d.apply(l, x);
+    d.apply(r + 1, T{} - x);
+    dk.apply(l, x * T(l));
+    dk.apply(r + 1, T{} - x * T(r + 1));
+  }
+
+  /// @brief Returns the sum of the elements in [0, i].
+  T query(std::size_t i) const { return d.query(i) * T(i + 1) - dk.query(i); }
+
+  /// @brief Returns the sum of the elements in [l, r].
+  T query(std::size_t l, std::size_t r) const { return l == 0 ? query(r) : query(r) - query(l - 1); }
+
+  std::size_t size() const { return n; }
+};
+} // namespace algo
@@ -1,22 +1,47 @@
 #pragma once
 
+#include "executor.hpp"
 #include "monoid.hpp"
 #include "proxy.hpp"
+#include "segment_tree_layout.hpp"
 #include <algorithm>
 #include <bit>
+#include <cassert>
 #include <istream>
 #include <ostream>
 #include <ranges>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace algo {
+namespace internal {
+inline void prefetch(const void *p) {
+#if defined(__GNUC__)
+  __builtin_prefetch(p);
+#endif
+}
+} // namespace internal
+
 /// @brief An iterative segment tree with a fixed size.
-template <typename T, typename f = std::plus<>, typename Id = monoid_identity<T, f>>
+/// @tparam Layout Where each node of the implicit heap-ordered tree is stored; see
+/// `segment_tree_layout.hpp`. The default keeps the classic `seg[i]` layout.
+template <typename T, typename f = std::plus<>, typename Id = monoid_identity<T, f>, typename Layout = heap_layout>
 class segment_tree {
 private:
   std::size_t _n, n;
+  [[no_unique_address]] Layout pos;
   std::vector<T> seg;
 
+  T &node(std::size_t i) { return seg[pos(i)]; }
+  const T &node(std::size_t i) const { return seg[pos(i)]; }
+
+  void build() {
+    for (std::size_t i = n - 1; i > 0; --i) {
+      node(i) = op(node(2 * i), node(2 * i + 1));
+    }
+  }
+
   T op(const T &a, const T &b) const {
     if constexpr (std::is_same_v<std::invoke_result_t<f &, T, T>, bool>) {
       return f{}(a, b) ? a : b;
@@ -30,27 +55,33 @@ private:
   using reference = internal::proxy_ref<segment_tree, T>;
 
 public:
-  segment_tree(std::size_t _n) : _n(_n), n(std::bit_ceil(_n)), seg(2 * n, base()) {}
-  segment_tree(const segment_tree &other) : _n(other._n), n(other.n), seg(other.seg) {}
+  segment_tree(std::size_t _n) : _n(_n), n(std::bit_ceil(_n)), pos(n), seg(pos.size(), base()) {}
+  segment_tree(const segment_tree &other) : _n(other._n), n(other.n), pos(other.pos), seg(other.seg) {}
   segment_tree() : _n(0), n(0) {}
-  segment_tree(std::size_t _n, const T &x) : _n(_n), n(std::bit_ceil(_n)), seg(2 * n) {
-    std::fill(seg.begin() + n, seg.begin() + n + _n, x);
-    for (std::size_t i = n - 1; i > 0; --i) {
-      seg[i] = op(seg[2 * i], seg[2 * i + 1]);
+  segment_tree(std::size_t _n, const T &x) : _n(_n), n(std::bit_ceil(_n)), pos(n), seg(pos.size(), base()) {
+    for (std::size_t i = 0; i < _n; ++i) {
+      node(n + i) = x;
     }
+    build();
   }
-  segment_tree(const std::vector<T> &vals) : _n(vals.size()), n(std::bit_ceil(_n)), seg(2 * n) {
+  segment_tree(const std::vector<T> &vals) : _n(vals.size()), n(std::bit_ceil(_n)), pos(n), seg(pos.size(), base()) {
     set(vals);
   }
+  /// @brief Builds the tree from `vals`, splitting the work across `ex`.
+  template <executor Executor>
+  segment_tree(const std::vector<T> &vals, const Executor &ex) : _n(vals.size()), n(std::bit_ceil(_n)), pos(n), seg(pos.size(), base()) {
+    set(vals, ex);
+  }
   template <typename It>
   segment_tree(It first, It last) {
     _n = std::distance(first, last);
     n = std::bit_ceil(_n);
-    seg.assign(2 * n, base());
-    std::copy(first, last, seg.begin() + n);
-    for (std::size_t i = n - 1; i > 0; --i) {
-      seg[i] = op(seg[2 * i], seg[2 * i + 1]);
+    pos = Layout(n);
+    seg.assign(pos.size(), base());
+    for (std::size_t i = n; first != last; ++first, ++i) {
+      node(i) = *first;
     }
+    build();
   }
   template <std::ranges::input_range R>
   segment_tree(R &&r) : segment_tree(std::ranges::begin(r), std::ranges::end(r)) {}
@@ -61,8 +92,8 @@ public:
   /// @param i The index at which the value is being modified.
   /// @param x The new value at that index.
   void set(std::size_t i, const T &x) {
-    for (seg[i += n] = x, i /= 2; i > 0; i /= 2) {
-      seg[i] = op(seg[2 * i], seg[2 * i + 1]);
+    for (node(i += n) = x, i /= 2; i > 0; i /= 2) {
+      node(i) = op(node(2 * i), node(2 * i + 1));
     }
   }
 
@@ -70,10 +101,26 @@ public:
   /// @param vals A vector of size `n`, where `vals[i]` is the value for index `i`.
   template <typename M>
   void set(const std::vector<M> &vals) {
-    std::copy(vals.begin(), vals.end(), seg.begin() + n);
-    for (std::size_t i = n - 1; i > 0; --i) {
-      seg[i] = op(seg[2 * i], seg[2 * i + 1]);
+    for (std::size_t i = 0; i < vals.size(); ++i) {
+      node(n + i) = vals[i];
     }
+    build();
+  }
+
+  /// @brief Bulk-assigns values to all leaves, rebuilding independent subtrees in parallel on
+  /// `ex` before the short serial pass over the top of the tree.
+  /// @param vals A vector of size `n`, where `vals[i]` is the value for index `i`.
+  /// @param ex The executor that runs the subtree builds, e.g. `thread_executor{}`.
+  template <typename M, executor Executor>
+  void set(const std::vector<M> &vals, const Executor &ex) {
+    internal::build_bottom_up(
+        n, ex,
+        [&](std::size_t i) {
+          if (i < vals.size()) {
+            node(n + i) = vals[i];
+          }
+        },
+        [&](std::size_t i) { node(i) = op(node(2 * i), node(2 * i + 1)); });
   }
 
   /// @brief Performs associative accumulation.
@@ -84,13 +131,39 @@ public:
     T ans_l = base(), ans_r = base();
     for (l += n, r += n + 1; l < r; l /= 2, r /= 2) {
       if (l & 1)
-        ans_l = op(ans_l, seg[l++]);
+        ans_l = op(ans_l, node(l++));
       if (r & 1)
-        ans_r = op(seg[--r], ans_r);
+        ans_r = op(node(--r), ans_r);
     }
     return op(ans_l, ans_r);
   }
 
+  /// @brief Answers many range queries at once. While query `k` is being walked, the
+  /// boundary paths of query `k + ahead` are prefetched, so the cache misses of upcoming
+  /// queries overlap with the work on the current one.
+  /// @param qs The inclusive ranges `[l, r]` to accumulate.
+  /// @param out Receives the results; `out[k]` is the accumulated result of `qs[k]`. Must hold at
+  /// least `qs.size()` elements.
+  void query_batch(std::span<const std::pair<std::size_t, std::size_t>> qs, std::span<T> out) const {
+    assert(out.size() >= qs.size());
+    constexpr std::size_t ahead = 8;
+    auto prefetch = [&](std::size_t k) {
+      for (std::size_t l = qs[k].first + n, r = qs[k].second + n; l < r; l /= 2, r /= 2) {
+        internal::prefetch(&node(l));
+        internal::prefetch(&node(r));
+      }
+    };
+    for (std::size_t k = 0; k < std::min(ahead, qs.size()); ++k) {
+      prefetch(k);
+    }
+    for (std::size_t k = 0; k < qs.size(); ++k) {
+      if (k + ahead < qs.size()) {
+        prefetch(k + ahead);
+      }
+      out[k] = query(qs[k].first, qs[k].second);
+    }
+  }
+
   /// @brief Finds the smallest index r ≥ l such that the predicate returns
   /// false for the accumulated value over [l, r].
   /// @param l The left boundary (inclusive) from which to start the
@@ -102,16 +175,16 @@ public:
   template <typename Fn>
   std::size_t min_right(std::size_t l, Fn &&t) const {
     T p = base();
-    for (l += n; t(op(p, seg[l])) && l & (l + 1); l /= 2) {
+    for (l += n; t(op(p, node(l))) && l & (l + 1); l /= 2) {
       if (l & 1)
-        p = op(p, seg[l++]);
+        p = op(p, node(l++));
     }
-    if (t(op(p, seg[l]))) {
+    if (t(op(p, node(l)))) {
       return _n;
     }
     while (l < n) {
-      if (t(op(p, seg[l <<= 1])))
-        p = op(p, seg[l++]);
+      if (t(op(p, node(l <<= 1))))
+        p = op(p, node(l++));
     }
     return l - n;
   }
@@ -120,9 +193,9 @@ public:
 
   /// @brief Returns a read-only reference to the value at index `i`.
   /// @param i The index to access.
-  /// @return A const reference to the element at position `i` in the segment tree (i.e., the leaf at `seg[n + i]`).
-  const T &at(std::size_t i) const { return seg[n + i]; }
-  const T &operator[](std::size_t i) const { return seg[n + i]; }
+  /// @return A const reference to the element at position `i` in the segment tree (i.e., the leaf `n + i`).
+  const T &at(std::size_t i) const { return node(n + i); }
+  const T &operator[](std::size_t i) const { return node(n + i); }
 
   reference operator[](std::size_t i) { return reference(this, i); }
   reference front() { return reference(this, 0); }
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+
+namespace algo {
+/// @brief The classic heap order: node `i` has children `2i` and `2i + 1`, and is stored at `i`.
+struct heap_layout {
+  std::size_t n = 0;
+
+  heap_layout() = default;
+  heap_layout(std::size_t n) : n(n) {}
+
+  std::size_t size() const { return 2 * n; }
+  std::size_t operator()(std::size_t i) const { return i; }
+};
+
+/// @brief Stores the tree as blocks of `log2(B)` consecutive levels, so that a node and its
+/// descendants down to the next `B` children share one block. With `B` values per cache line
+/// (e.g. `B = 8` for 8-byte values), a root-to-leaf walk touches one line per `log2(B)` levels
+/// instead of one line per level.
+/// @tparam B The number of children hanging below each block; must be a power of two.
+template <std::size_t B>
+  requires(B >= 2 && std::has_single_bit(B))
+struct wide_layout {
+  static constexpr int k = std::countr_zero(B);
+
+  // For a node at depth `d`, `shift[d]` is its depth inside its block and `base[d]` folds the
+  // block row's offset together with the in-block index of the block root.
+  std::array<std::size_t, 65> base{};
+  std::array<int, 65> shift{};
+  std::size_t total = 0;
+
+  wide_layout() = default;
+  wide_layout(std::size_t n) {
+    // Partial layers go on top, so the bottom layers (where almost all nodes live) are full.
+    int levels = std::bit_width(n), pad = (k - levels % k) % k;
+    for (int d = 0, L = -1; d < levels; ++d) {
+      int rd = std::max((d + pad) / k * k - pad, 0);
+      if ((d + pad) / k != L) {
+        L = (d + pad) / k;
+        total += std::size_t(1) << (rd + k);
+      }
+      shift[d] = d - rd;
+      base[d] = total - (std::size_t(1) << (rd + k)) - (std::size_t(1) << (rd + k)) + (std::size_t(1) << shift[d]);
+    }
+  }
+
+  std::size_t size() const { return total; }
+
+  std::size_t operator()(std::size_t i) const {
+    int d = std::bit_width(i) - 1;
+    return base[d] + ((i >> shift[d]) << k) + (i & ((std::size_t(1) << shift[d]) - 1));
+  }
+};
+
+/// @brief The van Emde Boas order: the top half of the levels is laid out recursively, followed
+/// by each bottom subtree laid out recursively. Any root-to-leaf walk touches `O(log_B n)` cache
+/// lines for every line size `B`, without tuning for a particular one.
+struct veb_layout {
+  // The recursion only depends on the depth of a node, so for every depth it is unrolled into at
+  // most 7 steps, each of which picks a bottom subtree from a window of the node's bits.
+  struct step {
+    int shift;
+    std::size_t mask, mult;
+  };
+  std::array<std::size_t, 65> base{};
+  std::array<std::array<step, 7>, 65> steps{};
+  std::array<int, 65> cnt{};
+  int levels = 0;
+
+  veb_layout() = default;
+  veb_layout(std::size_t n) : levels(std::bit_width(n)) {
+    for (int depth = 0; depth < levels; ++depth) {
+      base[depth] = 1;
+      for (int h = levels, d = depth; d > 0;) {
+        int top = h / 2, bottom = h - top;
+        if (d < top) {
+          h = top;
+          continue;
+        }
+        base[depth] += (std::size_t(1) << top) - 1;
+        steps[depth][cnt[depth]++] = {d - top, (std::size_t(1) << top) - 1, (std::size_t(1) << bottom) - 1};
+        d -= top, h = bottom;
+      }
+    }
+  }
+
+  std::size_t size() const { return std::size_t(1) << levels; }
+
+  std::size_t operator()(std::size_t i) const {
+    int d = std::bit_width(i) - 1;
+    std::size_t pos = base[d];
+    for (int s = 0; s < cnt[d]; ++s) {
+      pos += ((i >> steps[d][s].shift) & steps[d][s].mask) * steps[d][s].mult;
+    }
+    return pos;
+  }
+};
+} // namespace algo
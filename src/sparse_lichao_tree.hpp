@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <numeric>
 #include <optional>
+#include <ranges>
 #include <type_traits>
 #include <vector>
 
@@ -15,83 +19,127 @@ struct functor_traits<_R (C::*)(_A) const> {
   using R = _R;
   using A = std::decay_t<_A>;
 };
+
+/// @brief A slot of a Li Chao tree: a function, or nothing if `active` is false.
+template <typename _T>
+struct lichao_entry {
+  _T f;
+  bool active;
+  lichao_entry() : active(false) {}
+  lichao_entry(_T f) : f(f), active(true) {}
+};
 } // namespace internal
+
+/// @brief A Li Chao tree over a range of integers, creating nodes only where functions are
+/// inserted. Nodes are kept in one arena, link to their children by 32-bit indices, and derive
+/// their bounds from the descent; they are released together with the tree.
 template <typename _T, typename Comp = std::less<typename internal::functor_traits<_T>::R>>
 class sparse_lichao_tree {
 private:
   using int_t = typename internal::functor_traits<_T>::A;
-  struct T {
-    _T f;
-    bool active;
-    T() : active(false) {}
-    T(_T f) : f(f), active(true) {}
-  };
+  using T = internal::lichao_entry<_T>;
 
   struct node {
-    int_t L, R;
-    node *l, *r;
     T f;
-    bool active;
-    node(int_t L, int_t R) : L(L), R(R), l(nullptr), r(nullptr), active(false) {}
+    std::uint32_t l = 0, r = 0;
   };
 
+  int_t s, e;
+  std::vector<node> nodes;
+
   bool comp(const T &a, const T &b, int_t m) const {
     return a.active && (!b.active || Comp{}(a.f(m), b.f(m)));
   }
 
-  node *t;
-
-  void destroy(node *t) {
-    if (t) {
-      delete t->l;
-      delete t->r;
+  std::uint32_t child(std::uint32_t t, bool right) {
+    std::uint32_t c = right ? nodes[t].r : nodes[t].l;
+    if (!c) {
+      nodes.emplace_back();
+      c = nodes.size() - 1;
+      (right ? nodes[t].r : nodes[t].l) = c;
     }
-    delete t;
+    return c;
   }
 
-  void add(node *t, T f, int_t L, int_t R) {
-    if (t->R < L || R < t->L) {
-      return;
-    }
-    int_t m = std::midpoint(t->L, t->R);
-    if (L <= t->L && t->R <= R) {
-      if (comp(f, t->f, m)) {
-        std::swap(f, t->f);
+  // Inserts `f` into the subtree at `t`, which covers [L, R].
+  void insert(std::uint32_t t, T f, int_t L, int_t R) {
+    while (true) {
+      int_t m = std::midpoint(L, R);
+      if (comp(f, nodes[t].f, m)) {
+        std::swap(f, nodes[t].f);
       }
-      if (comp(f, t->f, t->L)) {
-        add(t->l = t->l ? t->l : new node(t->L, m), f, L, R);
+      if (L == R) {
+        return;
       }
-      if (comp(f, t->f, t->R)) {
-        add(t->r = t->r ? t->r : new node(m + 1, t->R), f, L, R);
+      if (comp(f, nodes[t].f, L)) {
+        t = child(t, false), R = m;
+      } else if (comp(f, nodes[t].f, R)) {
+        t = child(t, true), L = m + 1;
+      } else {
+        return;
       }
-      return;
     }
-    add(t->l = t->l ? t->l : new node(t->L, m), f, L, R);
-    add(t->r = t->r ? t->r : new node(m + 1, t->R), f, L, R);
   }
 
-  T query(node *t, int_t x) const {
-    if (!t || t->R < x || x < t->L) {
-      return T{};
+  void add(std::uint32_t t, int_t lo, int_t hi, const T &f, int_t l, int_t r) {
+    if (l <= lo && hi <= r) {
+      insert(t, f, lo, hi);
+      return;
     }
-    T ans = t->f;
-    if (T v = query(t->l, x); comp(v, ans, x)) {
-      ans = v;
+    int_t m = std::midpoint(lo, hi);
+    if (l <= m) {
+      add(child(t, false), lo, m, f, l, r);
     }
-    if (T v = query(t->r, x); comp(v, ans, x)) {
-      ans = v;
+    if (m < r) {
+      add(child(t, true), m + 1, hi, f, l, r);
     }
-    return ans;
   }
 
 public:
-  sparse_lichao_tree(int_t n) : t(new node(0, n - 1)) {}
-  ~sparse_lichao_tree() { destroy(t); }
+  sparse_lichao_tree(int_t n) : sparse_lichao_tree(0, n - 1) {}
+  sparse_lichao_tree(int_t l, int_t r) : s(l), e(r), nodes(2) {}
+
+  /// @brief Reserves arena space for `n` more nodes. Inserting a function over the whole range
+  /// creates at most `log2(r - l + 1) + 1` of them.
+  void reserve(std::size_t n) { nodes.reserve(nodes.size() + n); }
+
+  void add(int_t l, int_t r, const _T &x) {
+    if (std::max(l, s) <= std::min(r, e)) {
+      add(1, s, e, T{x}, l, r);
+    }
+  }
+  void add(const _T &x) { insert(1, T{x}, s, e); }
+
+  /// @brief Adds every function in `fs` over the whole range, reserving their nodes up front.
+  template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, _T>
+  void add(R &&fs) {
+    if constexpr (std::ranges::sized_range<R>) {
+      std::size_t depth = std::bit_width(std::make_unsigned_t<int_t>(e - s)) + 1;
+      reserve(std::min<std::size_t>(std::ranges::size(fs) * depth, 2 * std::size_t(e - s + 1)));
+    }
+    for (auto &&f : fs) {
+      insert(1, T{f}, s, e);
+    }
+  }
 
-  void add(int_t l, int_t r, const _T &x) { add(t, T{x}, l, r); }
-  void add(const _T &x) { add(t, T{x}, t->L, t->R); }
   std::optional<_T> query(int_t x) const {
-    T ans = query(t, x);
+    if (x < s || e < x) {
+      return std::nullopt;
+    }
+    T ans;
+    std::uint32_t t = 1;
+    for (int_t lo = s, hi = e; t;) {
+      if (comp(nodes[t].f, ans, x)) {
+        ans = nodes[t].f;
+      }
+      int_t m = std::midpoint(lo, hi);
+      if (x <= m) {
+        t = nodes[t].l, hi = m;
+      } else {
+        t = nodes[t].r, lo = m + 1;
+      }
+    }
     if (ans.active) {
       return ans.f;
     }
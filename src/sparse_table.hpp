@@ -1,37 +1,73 @@
 #pragma once
 
 #include "traits.hpp"
+#include <algorithm>
 #include <bit>
 #include <vector>
 
 namespace algo {
-template <typename T>
-  requires is_idempotent_v<T>
+/// @brief Answers range queries over a static array in `O(1)` after `O(n log n)` preprocessing.
+/// All levels live in one level-major buffer, so a level is built with a sequential sweep.
+/// @tparam T A monoid type with `operator+`.
+/// @tparam disjoint If `false`, every level `k` holds the sums of the windows of length `2^k`, and
+/// a query combines two overlapping windows, which needs `T` to be idempotent. If `true` (the
+/// default for non-idempotent `T`), it is a disjoint sparse table: level `k` cuts the array into
+/// blocks of `2^k` and holds, for every index, its sum to the middle of its block, so any monoid
+/// works.
+template <typename T, bool disjoint = !is_idempotent_v<T>>
+  requires(disjoint || is_idempotent_v<T>)
 class sparse_table {
 private:
   std::size_t n;
   int w;
-  std::vector<std::vector<T>> bin;
+  std::vector<T> bin;
+
+  T *level(int k) { return bin.data() + k * n; }
+  const T *level(int k) const { return bin.data() + k * n; }
 
 public:
   template <typename M>
-  sparse_table(const std::vector<M> &vals) : n(vals.size()), w(std::bit_width(n)), bin(n, std::vector<T>(w)) {
-    for (int i = 0; i < n; ++i) {
-      bin[i][0] = vals[i];
+  sparse_table(const std::vector<M> &vals) : n(vals.size()), w(disjoint ? std::bit_width(n > 1 ? n - 1 : 0) + 1 : std::bit_width(n)), bin(w * n) {
+    T *a = level(0);
+    for (std::size_t i = 0; i < n; ++i) {
+      a[i] = vals[i];
     }
-    for (int bt = 0; bt < w - 1; ++bt) {
-      for (int i = 0; i + (1 << bt) < n; ++i) {
-        bin[i][bt + 1] = bin[i][bt] + bin[i + (1 << bt)][bt];
+    for (int k = 1; k < w; ++k) {
+      T *cur = level(k);
+      if constexpr (disjoint) {
+        std::size_t half = std::size_t(1) << (k - 1);
+        for (std::size_t mid = half; mid < n; mid += 2 * half) {
+          cur[mid - 1] = a[mid - 1];
+          for (std::size_t i = mid - 1; i-- > mid - half;) {
+            cur[i] = a[i] + cur[i + 1];
+          }
+          cur[mid] = a[mid];
+          for (std::size_t i = mid + 1; i < std::min(mid + half, n); ++i) {
+            cur[i] = cur[i - 1] + a[i];
+          }
+        }
+      } else {
+        const T *prev = level(k - 1);
+        std::size_t half = std::size_t(1) << (k - 1);
+        for (std::size_t i = 0; i + 2 * half <= n; ++i) {
+          cur[i] = prev[i] + prev[i + half];
+        }
       }
     }
   }
 
   T query(std::size_t l, std::size_t r) const {
     if (l == r) {
-      return bin[l][0];
+      return bin[l];
+    }
+    if constexpr (disjoint) {
+      const T *cur = level(std::bit_width(l ^ r));
+      return cur[l] + cur[r];
+    } else {
+      int k = std::bit_width(r - l + 1) - 1;
+      const T *cur = level(k);
+      return cur[l] + cur[r - (std::size_t(1) << k) + 1];
     }
-    int k = std::bit_width(r - l + 1) - 1;
-    return bin[l][k] + bin[r - (1 << k) + 1][k];
   }
 };
-} // namespace algo
\ No newline at end of file
+} // namespace algo
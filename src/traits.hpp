@@ -7,4 +7,10 @@ template <typename T>
 struct is_idempotent : std::false_type {};
 template <typename T>
 inline constexpr bool is_idempotent_v = is_idempotent<T>::value;
+
+/// @brief Whether `a + b` is always `a` or `b`, as with `min` and `max` but not `gcd`.
+template <typename T>
+struct is_selective : std::false_type {};
+template <typename T>
+inline constexpr bool is_selective_v = is_selective<T>::value;
 } // namespace algo
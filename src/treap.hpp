@@ -1,134 +1,323 @@
 #pragma once
 
+#include "executor.hpp"
+#include "node_pool.hpp"
 #include <random>
+#include <ranges>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 namespace algo {
 /// @brief A binary search tree that keeps itself balanced through randomization.
 /// @tparam T A monoid type: must have `operator+` and an identity element defined.
-template <typename T>
+/// @tparam Nodes Where nodes are allocated; see `node_pool.hpp`.
+template <typename T, typename Nodes = heap_nodes>
 class treap {
 private:
   static inline std::mt19937 gen{std::random_device{}()};
 
+  struct node;
+  using pool = typename Nodes::template pool<node>;
+  using ptr = typename pool::ptr;
+  static constexpr ptr null = pool::null;
+
   struct node {
-    int64_t s, p;
-    node *l, *r;
+    int64_t s;
+    ptr l, r;
+    uint32_t p;
     T x, a;
-    node() : s(0), l(nullptr), r(nullptr), x(T{}), a(T{}), p(gen()) {}
-    node(const T &x_) : s(1), l(nullptr), r(nullptr), x(x_), a(x_), p(gen()) {}
+    node() : s(0), l(null), r(null), p(gen()), x(T{}), a(T{}) {}
+    node(const T &x_) : s(1), l(null), r(null), p(gen()), x(x_), a(x_) {}
   };
 
-  node *root;
+  // Keeps the pool alive for as long as this container.
+  [[no_unique_address]] typename pool::lifetime lifetime;
+  ptr root;
+
+  // The nodes visited by the last walk, pulled bottom-up once it is done. Per thread, so that the
+  // set operations can split on several threads at once.
+  static inline thread_local std::vector<ptr> path;
 
-  void destruct(node *n) {
-    if (n) {
-      destruct(n->l);
-      destruct(n->r);
-      delete n;
+  static node &get(ptr n) { return pool::get(n); }
+
+  // Rotates left children up until there are none, freeing nodes as they come off the top.
+  void destruct(ptr n) {
+    while (n) {
+      if (ptr l = get(n).l) {
+        get(n).l = get(l).r;
+        get(l).r = n;
+        n = l;
+      } else {
+        pool::free(std::exchange(n, get(n).r));
+      }
     }
   }
 
-  int64_t s(node *n) const { return n ? n->s : 0; }
-  T x(node *n) { return n ? n->x : T{}; }
-  T a(node *n) { return n ? n->a : T{}; }
+  int64_t s(ptr n) const { return n ? get(n).s : 0; }
+  T x(ptr n) { return n ? get(n).x : T{}; }
+  T a(ptr n) { return n ? get(n).a : T{}; }
 
-  node *pull(node *n) {
-    n->a = a(n->l) + n->x + a(n->r);
-    n->s = s(n->l) + s(n->r) + 1;
+  ptr pull(ptr n) {
+    node &d = get(n);
+    d.a = a(d.l) + d.x + a(d.r);
+    d.s = s(d.l) + s(d.r) + 1;
     return n;
   }
 
-  const T &at(node *n, int64_t i) const {
-    if (i == s(n->l)) {
-      return n->x;
+  void pull_path() {
+    for (std::size_t k = path.size(); k-- > 0;) {
+      pull(path[k]);
     }
-    if (i < s(n->l)) {
-      return at(n->l, i);
+    path.clear();
+  }
+
+  const T &at(ptr n, int64_t i) const {
+    while (i != s(get(n).l)) {
+      if (i < s(get(n).l)) {
+        n = get(n).l;
+      } else {
+        i -= s(get(n).l) + 1;
+        n = get(n).r;
+      }
     }
-    return at(n->r, i - s(n->l) - 1);
+    return get(n).x;
   }
 
-  node *set(node *n, int64_t i, const T &x) {
-    if (i == s(n->l)) {
-      n->x = x;
-    } else if (i < s(n->l)) {
-      set(n->l, i, x);
-    } else {
-      set(n->r, i - s(n->l) - 1, x);
+  ptr set(ptr n, int64_t i, const T &x) {
+    ptr t = n;
+    path.push_back(t);
+    while (i != s(get(t).l)) {
+      if (i < s(get(t).l)) {
+        t = get(t).l;
+      } else {
+        i -= s(get(t).l) + 1;
+        t = get(t).r;
+      }
+      path.push_back(t);
     }
-    return pull(n);
+    get(t).x = x;
+    pull_path();
+    return n;
   }
 
-  node *build(const std::vector<T> &a) {
-    std::vector<node *> st;
-    st.reserve(a.size());
-    node *root = nullptr;
+  // Builds a Cartesian tree in one left-to-right pass, keeping its right spine in `path`. Lower
+  // priorities go on top, matching `merge`.
+  template <typename R>
+  ptr build(R &&a) {
+    ptr root = null;
     for (const T &x : a) {
-      node *cur = new node(x);
-      node *prev = nullptr;
-      while (!st.empty() && st.back()->p < cur->p) {
-        prev = st.back();
-        st.pop_back();
+      ptr cur = pool::make(x);
+      ptr prev = null;
+      while (!path.empty() && get(cur).p < get(path.back()).p) {
+        prev = path.back();
+        path.pop_back();
         pull(prev);
       }
-      cur->l = prev;
-      if (!st.empty()) {
-        st.back()->r = cur;
+      get(cur).l = prev;
+      if (!path.empty()) {
+        get(path.back()).r = cur;
       } else {
         root = cur;
       }
-      st.push_back(cur);
-    }
-    for (int i = st.size() - 1; i >= 0; --i) {
-      pull(st[i]);
+      path.push_back(cur);
     }
+    pull_path();
     return root;
   }
 
-  std::pair<node *, node *> split(node *n, int64_t i) {
-    if (!n) {
-      return {nullptr, nullptr};
-    }
+  // Walks down once, hanging each node off the right spine of the left part or the left spine of
+  // the right part; `lh` and `rh` are the child slots where the next node of each part goes.
+  std::pair<ptr, ptr> split(ptr n, int64_t i) {
     if (i < 0) {
-      return {nullptr, n};
+      return {null, n};
+    }
+    ptr l = null, r = null, *lh = &l, *rh = &r;
+    while (n) {
+      path.push_back(n);
+      node &d = get(n);
+      if (int64_t ls = s(d.l); i >= ls) {
+        i -= ls + 1;
+        *lh = n;
+        lh = &d.r;
+        n = d.r;
+      } else {
+        *rh = n;
+        rh = &d.l;
+        n = d.l;
+      }
+    }
+    *lh = *rh = null;
+    pull_path();
+    return {l, r};
+  }
+
+  // Zips the right spine of `l` with the left spine of `r` by priority.
+  ptr merge(ptr l, ptr r) {
+    ptr m = null, *h = &m;
+    while (l && r) {
+      if (get(l).p < get(r).p) {
+        path.push_back(*h = l);
+        h = &get(l).r;
+        l = get(l).r;
+      } else {
+        path.push_back(*h = r);
+        h = &get(r).l;
+        r = get(r).l;
+      }
+    }
+    *h = l ? l : r;
+    pull_path();
+    return m;
+  }
+
+  // Like `split`, but by key: returns the nodes less than `k`, the node equal to `k` (detached, or
+  // null), and the nodes greater than `k`.
+  std::tuple<ptr, ptr, ptr> split_key(ptr n, const T &k) {
+    ptr l = null, m = null, r = null, *lh = &l, *rh = &r;
+    while (n) {
+      node &d = get(n);
+      if (d.x < k) {
+        path.push_back(n);
+        *lh = n;
+        lh = &d.r;
+        n = d.r;
+      } else if (k < d.x) {
+        path.push_back(n);
+        *rh = n;
+        rh = &d.l;
+        n = d.l;
+      } else {
+        m = n;
+        n = null;
+        *lh = std::exchange(d.l, null);
+        *rh = std::exchange(d.r, null);
+        pull(m);
+      }
+    }
+    if (!m) {
+      *lh = *rh = null;
+    }
+    pull_path();
+    return {l, m, r};
+  }
+
+  // Runs `fl` and `fr`, in parallel on `ex` while fewer than `ex.concurrency()` tasks are running
+  // and there are at least `cutoff` nodes to process.
+  template <typename Executor, typename Fl, typename Fr>
+  static void fork(const Executor &ex, int depth, int64_t size, Fl &&fl, Fr &&fr) {
+    static constexpr int64_t cutoff = 1 << 12;
+    if ((std::size_t(1) << depth) < ex.concurrency() && size >= cutoff) {
+      ex(2, [&](std::size_t t) { t ? fr() : fl(); });
+    } else {
+      fl(), fr();
+    }
+  }
+
+  // The set operations below never allocate; the nodes they drop are collected in `drop` and
+  // freed afterwards on the calling thread, since pools are not thread-safe. `swapped` tells
+  // whether `a` came from the other treap, so that equal elements keep this treap's value.
+  template <typename Executor>
+  ptr unite(ptr a, ptr b, bool swapped, const Executor &ex, int depth, std::vector<ptr> &drop) {
+    if (!a || !b) {
+      return a ? a : b;
+    }
+    if (get(b).p < get(a).p) {
+      std::swap(a, b);
+      swapped = !swapped;
+    }
+    auto [l, m, r] = split_key(b, get(a).x);
+    if (m) {
+      if (swapped) {
+        std::swap(get(a).x, get(m).x);
+      }
+      drop.push_back(m);
     }
-    if (i == s(n->l)) {
-      node *r = std::exchange(n->r, nullptr);
-      return {pull(n), r};
+    ptr al = get(a).l, ar = get(a).r;
+    std::vector<ptr> drop_r;
+    fork(
+        ex, depth, s(a) + s(l) + s(r),
+        [&] { al = unite(al, l, swapped, ex, depth + 1, drop); },
+        [&] { ar = unite(ar, r, swapped, ex, depth + 1, drop_r); });
+    drop.insert(drop.end(), drop_r.begin(), drop_r.end());
+    get(a).l = al, get(a).r = ar;
+    return pull(a);
+  }
+
+  template <typename Executor>
+  ptr intersect(ptr a, ptr b, bool swapped, const Executor &ex, int depth, std::vector<ptr> &drop) {
+    if (!a || !b) {
+      if (a || b) {
+        drop.push_back(a ? a : b);
+      }
+      return null;
+    }
+    if (get(b).p < get(a).p) {
+      std::swap(a, b);
+      swapped = !swapped;
     }
-    if (i < s(n->l)) {
-      auto [l, r] = split(std::exchange(n->l, nullptr), i);
-      return {l, merge(r, pull(n))};
+    auto [l, m, r] = split_key(b, get(a).x);
+    ptr al = get(a).l, ar = get(a).r;
+    std::vector<ptr> drop_r;
+    fork(
+        ex, depth, s(a) + s(l) + s(r),
+        [&] { al = intersect(al, l, swapped, ex, depth + 1, drop); },
+        [&] { ar = intersect(ar, r, swapped, ex, depth + 1, drop_r); });
+    drop.insert(drop.end(), drop_r.begin(), drop_r.end());
+    if (m) {
+      if (swapped) {
+        std::swap(get(a).x, get(m).x);
+      }
+      drop.push_back(m);
+      get(a).l = al, get(a).r = ar;
+      return pull(a);
     }
-    auto [l, r] = split(std::exchange(n->r, nullptr), i - s(n->l) - 1);
-    return {merge(pull(n), l), r};
+    get(a).l = get(a).r = null;
+    drop.push_back(a);
+    return merge(al, ar);
   }
 
-  node *merge(node *l, node *r) {
-    if (!l) {
-      return r;
+  template <typename Executor>
+  ptr subtract(ptr a, ptr b, const Executor &ex, int depth, std::vector<ptr> &drop) {
+    if (!a || !b) {
+      if (b) {
+        drop.push_back(b);
+      }
+      return a;
     }
-    if (!r) {
-      return l;
+    auto [l, m, r] = split_key(b, get(a).x);
+    ptr al = get(a).l, ar = get(a).r;
+    std::vector<ptr> drop_r;
+    fork(
+        ex, depth, s(a) + s(l) + s(r),
+        [&] { al = subtract(al, l, ex, depth + 1, drop); },
+        [&] { ar = subtract(ar, r, ex, depth + 1, drop_r); });
+    drop.insert(drop.end(), drop_r.begin(), drop_r.end());
+    if (m) {
+      drop.push_back(m);
+      get(a).l = get(a).r = null;
+      drop.push_back(a);
+      return merge(al, ar);
     }
-    if (l->p < r->p) {
-      l->r = merge(l->r, r);
-      return pull(l);
+    get(a).l = al, get(a).r = ar;
+    return pull(a);
+  }
+
+  void free_all(const std::vector<ptr> &drop) {
+    for (ptr n : drop) {
+      destruct(n);
     }
-    r->l = merge(l, r->l);
-    return pull(r);
   }
 
-  node *insert(node *n, int64_t i, const T &x) {
+  ptr insert(ptr n, int64_t i, const T &x) {
     auto [l, r] = split(n, i - 1);
-    return merge(l, merge(new node(x), r));
+    return merge(l, merge(pool::make(x), r));
   }
 
-  node *erase(node *n, int64_t i) {
+  ptr erase(ptr n, int64_t i) {
     auto [l, r1] = split(n, i - 1);
     auto [m, r] = split(r1, 0);
-    delete m;
+    pool::free(m);
     return merge(l, r);
   }
 
@@ -140,15 +329,21 @@ private:
     return ans;
   }
 
-  treap(node *n) : root(n) {}
+  treap(ptr n) : root(n) {}
 
 public:
-  treap() : root(nullptr) {}
+  treap() : root(null) {}
   treap(const std::vector<T> &a) { root = build(a); }
   treap(const treap &) = delete;
   treap &operator=(const treap &) = delete;
-  treap(treap &&) noexcept = default;
-  treap &operator=(treap &&) noexcept = default;
+  treap(treap &&other) noexcept : root(std::exchange(other.root, null)) {}
+  treap &operator=(treap &&other) noexcept {
+    if (this != &other) {
+      destruct(root);
+      root = std::exchange(other.root, null);
+    }
+    return *this;
+  }
   ~treap() { destruct(root); }
 
   /// @brief Returns the current size of the treap.
@@ -169,6 +364,13 @@ public:
     merge(r);
   }
 
+  /// @brief Appends all the elements of `a` to the end of the treap in `O(|a| + log n)`: they are
+  /// built into a treap in one pass, which is then merged in once.
+  /// @param a The elements to append, in order.
+  template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, T>
+  void append(R &&a) { root = merge(root, build(a)); }
+
   /// @brief Erases the `i`-th element.
   /// @param i The index whose element needs to be erased.
   void erase(std::size_t i) { root = erase(root, i); }
@@ -202,10 +404,50 @@ public:
   /// @note `other` can be safely reused or destroyed; it simply holds no elements after this.
   void merge(treap &other) {
     root = merge(root, other.root);
-    other.root = nullptr;
+    other.root = null;
   }
   void merge(treap &&other) { merge(other); }
 
+  /// @brief Replaces this treap with the union of this treap and `other`, in
+  /// `O(m log(n / m + 1))` expected work for sizes `m ≤ n`. Elements of `other` equal to one in this
+  /// treap are dropped.
+  /// @param other Another treap. After the call, it becomes empty.
+  /// @note The set operations treat a treap as a set ordered by key: both treaps must be strictly
+  /// increasing under `operator<`, and the result is too.
+  void unite(treap &other) { unite(other, serial_executor{}); }
+
+  /// @brief Like `unite(other)`, but forks the two recursive halves onto `ex` near the top of the
+  /// recursion, for `O(log^2 n)` expected span.
+  template <executor Executor>
+  void unite(treap &other, const Executor &ex) {
+    std::vector<ptr> drop;
+    root = unite(root, std::exchange(other.root, null), false, ex, 0, drop);
+    free_all(drop);
+  }
+
+  /// @brief Keeps only the elements of this treap that also appear in `other`; the elements kept
+  /// are this treap's, not their equals from `other`.
+  /// @param other Another treap. After the call, it becomes empty.
+  void intersect(treap &other) { intersect(other, serial_executor{}); }
+
+  template <executor Executor>
+  void intersect(treap &other, const Executor &ex) {
+    std::vector<ptr> drop;
+    root = intersect(root, std::exchange(other.root, null), false, ex, 0, drop);
+    free_all(drop);
+  }
+
+  /// @brief Removes the elements of this treap that appear in `other`.
+  /// @param other Another treap. After the call, it becomes empty.
+  void subtract(treap &other) { subtract(other, serial_executor{}); }
+
+  template <executor Executor>
+  void subtract(treap &other, const Executor &ex) {
+    std::vector<ptr> drop;
+    root = subtract(root, std::exchange(other.root, null), ex, 0, drop);
+    free_all(drop);
+  }
+
   /// @brief Cuts out the range [l, r] from the treap and returns it. Note that the treap this is called on is modified.
   /// @param l The starting index of the range.
   /// @param r The ending index of the range.
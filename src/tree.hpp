@@ -3,7 +3,9 @@
 #include "segment_tree.hpp"
 #include <algorithm>
 #include <functional>
+#include <span>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace algo {
@@ -13,45 +15,126 @@ class tree {
 private:
   std::size_t n;
   std::vector<std::vector<T>> adj;
+  // Once frozen, the neighbours of `u` are `targets[offset[u]] ... targets[offset[u + 1] - 1]`.
+  std::vector<std::size_t> offset;
+  std::vector<T> targets;
   T valid_node = -1;
 
+  bool frozen() const { return !offset.empty(); }
+
+  void thaw() {
+    adj.assign(n, {});
+    for (std::size_t u = 0; u < n; ++u) {
+      adj[u].assign(targets.begin() + offset[u], targets.begin() + offset[u + 1]);
+    }
+    offset.clear(), offset.shrink_to_fit();
+    targets.clear(), targets.shrink_to_fit();
+  }
+
 public:
   tree(std::size_t n) : n(n), adj(n) {}
 
+  /// @brief Builds a frozen tree straight from its edges with a counting sort, without ever
+  /// allocating a list per vertex.
+  tree(std::size_t n, const std::vector<std::pair<T, T>> &edges) : n(n), offset(n + 1), targets(2 * edges.size()) {
+    for (const auto &[u, v] : edges) {
+      ++offset[u + 1], ++offset[v + 1];
+    }
+    for (std::size_t u = 0; u < n; ++u) {
+      offset[u + 1] += offset[u];
+    }
+    std::vector<std::size_t> pos(offset.begin(), offset.end() - 1);
+    for (const auto &[u, v] : edges) {
+      targets[pos[u]++] = v;
+      targets[pos[v]++] = u;
+    }
+    if (!edges.empty()) {
+      valid_node = edges.back().first;
+    }
+  }
+
   std::size_t size() const { return n; }
 
   void add_edge(const T &u, const T &v) {
+    if (frozen()) {
+      thaw();
+    }
     valid_node = u;
     adj[u].push_back(v);
     adj[v].push_back(u);
   }
 
-  /// @brief Returns the adjacency list of the tree.
+  /// @brief Packs the adjacency lists into two flat arrays (compressed sparse row): one offset per
+  /// vertex and all neighbours back to back. Adding an edge afterwards unpacks them again.
+  void freeze() {
+    if (frozen()) {
+      return;
+    }
+    offset.assign(n + 1, 0);
+    for (std::size_t u = 0; u < n; ++u) {
+      offset[u + 1] = offset[u] + adj[u].size();
+    }
+    targets.resize(offset[n]);
+    for (std::size_t u = 0; u < n; ++u) {
+      std::copy(adj[u].begin(), adj[u].end(), targets.begin() + offset[u]);
+    }
+    std::vector<std::vector<T>>().swap(adj);
+  }
+
+  /// @brief Returns the neighbours of `u`.
+  std::span<const T> neighbors(const T &u) const {
+    if (frozen()) {
+      return {targets.data() + offset[u], targets.data() + offset[u + 1]};
+    }
+    return adj[u];
+  }
+
+  /// @brief Returns the adjacency list of the tree. Empty while the tree is frozen; use
+  /// `neighbors()` to work with either representation.
   const std::vector<std::vector<T>> &adjacency() const { return adj; }
 
+  /// @brief Depth-first search from `root`, calling `on_enter(u, p)` when `u` is first reached from
+  /// its parent `p` (`-1` for the root), `on_before(u, i)` and `on_after(u, i)` around the visit to
+  /// each child `i` of `u`, and `on_exit(u, p)` once `u`'s subtree is done. Any hook may be `nullptr`.
+  /// The walk keeps its own stack, so it handles trees of any depth.
   template <typename enter, typename child_before, typename child_after, typename exit>
   void dfs(enter &&on_enter, child_before &&on_before, child_after &&on_after, exit &&on_exit, const T &root) const {
-    auto dfs = [&](auto &&self, const T &u, const T &p) -> void {
-      if constexpr (!std::is_same_v<enter, std::nullptr_t>) {
-        on_enter(u, p);
+    struct frame {
+      T u, p;
+      std::size_t next;
+    };
+    std::vector<frame> stack{{root, T(-1), 0}};
+    if constexpr (!std::is_same_v<enter, std::nullptr_t>) {
+      on_enter(root, T(-1));
+    }
+    while (!stack.empty()) {
+      frame &f = stack.back();
+      T u = f.u, p = f.p;
+      std::span<const T> ch = neighbors(u);
+      while (f.next < ch.size() && ch[f.next] == p) {
+        ++f.next;
       }
-      for (const T &i : adj[u]) {
-        if (i == p) {
-          continue;
-        }
-        if constexpr (!std::is_same_v<child_before, std::nullptr_t>) {
-          on_before(u, i);
+      if (f.next == ch.size()) {
+        stack.pop_back();
+        if constexpr (!std::is_same_v<exit, std::nullptr_t>) {
+          on_exit(u, p);
         }
-        self(self, i, u);
         if constexpr (!std::is_same_v<child_after, std::nullptr_t>) {
-          on_after(u, i);
+          if (!stack.empty()) {
+            on_after(p, u);
+          }
         }
+        continue;
       }
-      if constexpr (!std::is_same_v<exit, std::nullptr_t>) {
-        on_exit(u, p);
+      T i = ch[f.next++];
+      if constexpr (!std::is_same_v<child_before, std::nullptr_t>) {
+        on_before(u, i);
       }
-    };
-    dfs(dfs, root, -1);
+      stack.push_back({i, u, 0});
+      if constexpr (!std::is_same_v<enter, std::nullptr_t>) {
+        on_enter(i, u);
+      }
+    }
   }
 
   /// @brief Depth-first search with the `child_after` hook.
@@ -74,6 +157,59 @@ public:
     return ans;
   }
 
+  struct bfs_order_result {
+    std::vector<T> order, par, pre;
+    std::vector<int> start, end;
+  };
+
+  /// @brief Lists the nodes in breadth-first order and in preorder from @p root, along with each
+  /// node's parent, with two linear passes and no recursion. Every parent comes before its
+  /// children in both orders, so a top-down DP can sweep either forwards and a bottom-up DP
+  /// backwards (reversed, `pre` is a postorder). In `pre`, every subtree is contiguous.
+  ///
+  /// @param root The root of the tree.
+  /// @return `order`, the nodes in BFS order; `par`, where `par[u]` is the parent of node `u` (the
+  /// root's parent is itself); `pre`, the nodes in preorder; and `start` and `end`, where the
+  /// subtree of `u` is `pre[start[u]], ..., pre[end[u]]`.
+  bfs_order_result bfs_order(const T &root) const {
+    bfs_order_result ans{std::vector<T>(n), std::vector<T>(n), std::vector<T>(n), std::vector<int>(n), std::vector<int>(n)};
+    if (n == 0) {
+      return ans;
+    }
+    // Preorder with an explicit stack: a node's subtree is finished before anything below it on
+    // the stack is popped.
+    std::vector<T> stack{root};
+    ans.par[root] = root;
+    for (int timer = 0; !stack.empty(); ++timer) {
+      T u = stack.back();
+      stack.pop_back();
+      ans.pre[timer] = u;
+      ans.start[u] = ans.end[u] = timer;
+      for (const T &i : neighbors(u)) {
+        if (i != ans.par[u]) {
+          ans.par[i] = u;
+          stack.push_back(i);
+        }
+      }
+    }
+    // Children come after their parents in `pre`, so sweeping it backwards finishes every
+    // subtree before passing its last index up.
+    for (std::size_t k = n; k-- > 1;) {
+      T u = ans.pre[k];
+      ans.end[ans.par[u]] = std::max(ans.end[ans.par[u]], ans.end[u]);
+    }
+    ans.order[0] = root;
+    for (std::size_t head = 0, tail = 1; head < tail; ++head) {
+      T u = ans.order[head];
+      for (const T &i : neighbors(u)) {
+        if (i != ans.par[u]) {
+          ans.order[tail++] = i;
+        }
+      }
+    }
+    return ans;
+  }
+
   /// @brief Computes the depth of each node from a given root.
   ///
   /// @param root The root of the tree.
@@ -226,17 +362,17 @@ public:
     return lift_view<binary_lift_size>(*this, root);
   }
 
-  template <typename M>
+  template <typename M, typename Layout = heap_layout>
   class flatten_view {
   private:
     const tree<T> &g;
     std::vector<int> start, end;
-    segment_tree<M> seg;
+    segment_tree<M, std::plus<>, monoid_identity<M, std::plus<>>, Layout> seg;
 
   public:
-    flatten_view(const tree<T> &g, const T &root) : g(g), start(g.size()), end(g.size()), seg(g.size()) {
-      int timer = 0;
-      g.dfs([&](const T &u, const T &p) { start[u] = timer++; }, nullptr, nullptr, [&](const T &u, const T &p) { end[u] = timer - 1; }, root);
+    flatten_view(const tree<T> &g, const T &root) : g(g), seg(g.size()) {
+      auto orders = g.bfs_order(root);
+      start = std::move(orders.start), end = std::move(orders.end);
     }
 
     /// @brief Set the value at node `u`.
@@ -286,30 +422,31 @@ public:
   /// This allows subtree queries and point updates to be reduced to range queries.
   ///
   /// @tparam M The monoid type (must define `operator+` and have an identity).
+  /// @tparam Layout The node layout of the underlying segment tree.
   /// @param root The root of the tree.
   /// @return A `flatten_view<M>` object supporting subtree aggregation.
-  template <typename M>
-  flatten_view<M> flatten(const T &root) const {
-    return flatten_view<M>{*this, root};
+  template <typename M, typename Layout = heap_layout>
+  flatten_view<M, Layout> flatten(const T &root) const {
+    return flatten_view<M, Layout>{*this, root};
   }
 
   /// @brief Overload that also bulk-initializes node values.
   /// @param vals `std::vector` of values (size = number of nodes), where `vals[u]` is the value of node `u`.
   /// @param root The root of the tree.
   /// @return A `flatten_view<M>` initialized with `vals`.
-  template <typename M>
-  flatten_view<M> flatten(const std::vector<M> &vals, const T &root) const {
-    flatten_view<M> fv{*this, root};
+  template <typename M, typename Layout = heap_layout>
+  flatten_view<M, Layout> flatten(const std::vector<M> &vals, const T &root) const {
+    flatten_view<M, Layout> fv{*this, root};
     fv.set(vals);
     return fv;
   }
 
-  template <typename M>
+  template <typename M, typename Layout = heap_layout>
   class hld_view {
   private:
     const tree<T> &g;
     std::vector<int> start, top, par, depth;
-    segment_tree<M> seg;
+    segment_tree<M, std::plus<>, monoid_identity<M, std::plus<>>, Layout> seg;
 
     template <typename Fn>
     M query_path(T u, T v, Fn &&handle_last) const {
@@ -330,34 +467,39 @@ public:
 
   public:
     hld_view(const tree<T> &g, const T &root) : g(g), start(g.size()), top(g.size()), par(g.par(root)), depth(g.dep(root)), seg(g.size()) {
-      std::vector<std::vector<T>> adj = g.adjacency();
-      std::vector<int> sub(g.size());
-      auto dfs1 = [&](auto &&self, T u, T p) -> void {
-        for (T &i : adj[u]) {
-          if (i == p) {
-            continue;
-          }
-          self(self, i, u);
-          sub[u] += sub[i] + 1;
-          if (sub[i] > sub[adj[u][0]]) {
-            std::swap(i, adj[u][0]);
-          }
+      std::vector<int> sub(g.size(), 1);
+      std::vector<T> heavy(g.size(), -1);
+      // Children before parents: sum up subtree sizes and pick each node's heaviest child.
+      std::vector<T> order = g.bfs_order(root).order;
+      for (std::size_t k = order.size(); k-- > 1;) {
+        T u = order[k];
+        sub[par[u]] += sub[u];
+      }
+      for (std::size_t k = order.size(); k-- > 1;) {
+        T u = order[k], p = par[u];
+        if (heavy[p] == -1 || sub[u] > sub[heavy[p]]) {
+          heavy[p] = u;
         }
-      };
+      }
+      // Preorder, heavy child first, so that every heavy chain gets consecutive positions.
       int timer = 0;
-      auto dfs2 = [&](auto &&self, T u, T p) -> void {
+      top[root] = root;
+      std::vector<T> stack{root};
+      while (!stack.empty()) {
+        T u = stack.back();
+        stack.pop_back();
         start[u] = timer++;
-        for (T &i : adj[u]) {
-          if (i == p) {
-            continue;
+        for (const T &i : g.neighbors(u)) {
+          if (i != par[u] && i != heavy[u]) {
+            top[i] = i;
+            stack.push_back(i);
           }
-          top[i] = i == adj[u][0] ? top[u] : i;
-          self(self, i, u);
         }
-      };
-      dfs1(dfs1, root, -1);
-      top[root] = root;
-      dfs2(dfs2, root, -1);
+        if (heavy[u] != -1) {
+          top[heavy[u]] = top[u];
+          stack.push_back(heavy[u]);
+        }
+      }
     }
 
     void set(std::size_t i, const M &x) {
@@ -368,16 +510,17 @@ public:
     /// @param u The node to start at.
     /// @param k The amount of edges to go up.
     /// @return If `k == 0`, returns the monoid identity. Otherwise, returns the monoid aggregate for `k` edges.
-    M accum(const T &u, int k) const {
+    M accum(T u, int k) const {
       k = std::min(k, depth[u]);
       M ans = M{};
-      while (k > 0 && k - (depth[u] - depth[top[u]]) >= 0) {
+      // Each edge's value sits at its lower node, so this sums the `k` nodes from `u` upwards.
+      while (k > 0 && k > depth[u] - depth[top[u]]) {
         ans = ans + seg.query(start[top[u]], start[u]);
-        k -= depth[u] - depth[top[u]];
+        k -= depth[u] - depth[top[u]] + 1;
         u = par[top[u]];
       }
       if (k > 0) {
-        ans = ans + seg.query(start[u] - k, start[u]);
+        ans = ans + seg.query(start[u] - k + 1, start[u]);
       }
       return ans;
     }
@@ -421,11 +564,12 @@ public:
 
   /// @brief Builds a heavy-light decomposition view of the tree.
   /// @tparam M The monoid type (must define `operator+` and have an identity).
+  /// @tparam Layout The node layout of the underlying segment tree.
   /// @param root The root of the decomposition.
   /// @return An `hld_view<M>` object supporting path queries and updates.
-  template <typename M>
-  hld_view<M> hld(const T &root) const {
-    return hld_view<M>{*this, root};
+  template <typename M, typename Layout = heap_layout>
+  hld_view<M, Layout> hld(const T &root) const {
+    return hld_view<M, Layout>{*this, root};
   }
 };
 }; // namespace algo
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace algo {
+/// @brief A static wavelet matrix: order statistics and value-range counting over any range of a
+/// fixed array in `O(log σ)`, where `σ` is the number of distinct values. Values are compressed to
+/// their rank among the distinct values, and each of the `log σ` levels stores one bit per element
+/// plus a 32-bit popcount directory per 64 bits.
+/// @tparam T A totally ordered type.
+template <typename T>
+class wavelet_matrix {
+private:
+  // One level: the current bit of every element, in the order the elements have at this level.
+  struct bit_vector {
+    std::vector<std::uint64_t> bits;
+    std::vector<std::uint32_t> ranks;
+    std::uint32_t zeros = 0;
+
+    bit_vector(std::size_t n) : bits(n / 64 + 1), ranks(n / 64 + 1) {}
+
+    void build() {
+      for (std::size_t i = 1; i < bits.size(); ++i) {
+        ranks[i] = ranks[i - 1] + std::popcount(bits[i - 1]);
+      }
+    }
+
+    bool get(std::size_t i) const { return bits[i / 64] >> (i % 64) & 1; }
+
+    /// @brief The number of set bits in [0, i).
+    std::size_t rank1(std::size_t i) const {
+      return ranks[i / 64] + std::popcount(bits[i / 64] & ((std::uint64_t(1) << (i % 64)) - 1));
+    }
+    std::size_t rank0(std::size_t i) const { return i - rank1(i); }
+  };
+
+  std::size_t n;
+  int h;
+  std::vector<T> vals;
+  std::vector<bit_vector> levels;
+
+  // The number of elements in [a, b) whose compressed value is less than `c`.
+  std::size_t count_below(std::size_t a, std::size_t b, std::size_t c) const {
+    if (c >> h) {
+      return b - a;
+    }
+    std::size_t ans = 0;
+    for (int d = 0; d < h; ++d) {
+      const bit_vector &bv = levels[d];
+      std::size_t za = bv.rank0(a), zb = bv.rank0(b);
+      if (c >> (h - 1 - d) & 1) {
+        ans += zb - za;
+        a = bv.zeros + (a - za), b = bv.zeros + (b - zb);
+      } else {
+        a = za, b = zb;
+      }
+    }
+    return ans;
+  }
+
+  std::size_t lower(const T &x) const { return std::lower_bound(vals.begin(), vals.end(), x) - vals.begin(); }
+  std::size_t upper(const T &x) const { return std::upper_bound(vals.begin(), vals.end(), x) - vals.begin(); }
+
+public:
+  template <typename M>
+  wavelet_matrix(const std::vector<M> &a) : n(a.size()), vals(a.begin(), a.end()) {
+    std::sort(vals.begin(), vals.end());
+    vals.erase(std::unique(vals.begin(), vals.end()), vals.end());
+    h = std::bit_width(vals.size() > 1 ? vals.size() - 1 : 0);
+    std::vector<std::uint32_t> cur(n), next(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      cur[i] = lower(a[i]);
+    }
+    levels.reserve(h);
+    for (int d = 0; d < h; ++d) {
+      bit_vector &bv = levels.emplace_back(n);
+      int bit = h - 1 - d;
+      for (std::size_t i = 0; i < n; ++i) {
+        if (cur[i] >> bit & 1) {
+          bv.bits[i / 64] |= std::uint64_t(1) << (i % 64);
+        } else {
+          ++bv.zeros;
+        }
+      }
+      bv.build();
+      // Stable partition: elements with a 0 at this bit first.
+      std::size_t z = 0, o = bv.zeros;
+      for (std::size_t i = 0; i < n; ++i) {
+        next[(cur[i] >> bit & 1) ? o++ : z++] = cur[i];
+      }
+      std::swap(cur, next);
+    }
+  }
+
+  /// @brief Returns the value at index `i`.
+  T at(std::size_t i) const {
+    std::size_t c = 0;
+    for (int d = 0; d < h; ++d) {
+      const bit_vector &bv = levels[d];
+      if (bv.get(i)) {
+        c |= std::size_t(1) << (h - 1 - d);
+        i = bv.zeros + bv.rank1(i);
+      } else {
+        i = bv.rank0(i);
+      }
+    }
+    return vals[c];
+  }
+
+  /// @brief Returns the `k`-th smallest value (0-indexed) in [l, r].
+  /// @param k Must be less than `r - l + 1`.
+  T kth_smallest(std::size_t l, std::size_t r, std::size_t k) const {
+    std::size_t a = l, b = r + 1, c = 0;
+    for (int d = 0; d < h; ++d) {
+      const bit_vector &bv = levels[d];
+      std::size_t za = bv.rank0(a), zb = bv.rank0(b);
+      if (k < zb - za) {
+        a = za, b = zb;
+      } else {
+        k -= zb - za;
+        c |= std::size_t(1) << (h - 1 - d);
+        a = bv.zeros + (a - za), b = bv.zeros + (b - zb);
+      }
+    }
+    return vals[c];
+  }
+
+  /// @brief Returns the `k`-th largest value (0-indexed) in [l, r].
+  T kth_largest(std::size_t l, std::size_t r, std::size_t k) const { return kth_smallest(l, r, r - l - k); }
+
+  /// @brief Returns the number of values in [l, r] that are less than `x`.
+  std::size_t count_less(std::size_t l, std::size_t r, const T &x) const { return count_below(l, r + 1, lower(x)); }
+
+  /// @brief Returns the number of values in [l, r] that lie in [lo, hi].
+  std::size_t range_freq(std::size_t l, std::size_t r, const T &lo, const T &hi) const {
+    if (hi < lo) {
+      return 0;
+    }
+    return count_below(l, r + 1, upper(hi)) - count_below(l, r + 1, lower(lo));
+  }
+
+  /// @brief Returns the number of occurrences of `x` in [l, r].
+  std::size_t count(std::size_t l, std::size_t r, const T &x) const { return range_freq(l, r, x, x); }
+
+  std::size_t size() const { return n; }
+};
+} // namespace algo